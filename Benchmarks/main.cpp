@@ -0,0 +1,394 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Microbenchmarks for the per frame getters, setters and the
+// checksum. Results are written to or compared against a baseline
+// file of "name median_nanoseconds_per_op noise_nanoseconds" lines.
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "Checksum.h"
+#include "CorpusGenerator.h"
+#include "Eeprom.h"
+#include "NvSettingsEmulator.h"
+
+namespace
+{
+  typedef void (*BenchmarkFunction)(unsigned long long iterations);
+
+  struct Benchmark
+  {
+    const char* name;
+    BenchmarkFunction function;
+  };
+
+  EEasyXB::Eeprom* g_eeprom = NULL;
+  EEasyXB::EepromData g_image;
+
+  // Calls made per loop iteration, so the loop itself is a small
+  // part of what is timed. Results are reported per call.
+  const unsigned int CALLS_PER_ITERATION = 16;
+
+  // Keeps the compiler from discarding a result
+  template <typename T>
+  inline void DoNotOptimize(const T& value)
+  {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  void BM_IsResolutionEnabled(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        DoNotOptimize(g_eeprom->IsResolutionEnabled(EEasyXB::SupportedResolution::RESOLUTION_720p));
+      }
+    }
+  }
+
+  void BM_IsAudioModeEnabled(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        DoNotOptimize(g_eeprom->IsAudioModeEnabled(EEasyXB::AudioMode::STEREO));
+      }
+    }
+  }
+
+  void BM_GetActiveAspectRatio(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        DoNotOptimize(g_eeprom->GetActiveAspectRatio());
+      }
+    }
+  }
+
+  void BM_SetResolutionEnabled(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        g_eeprom->SetResolutionEnabled(EEasyXB::SupportedResolution::RESOLUTION_1080i, (j & 1) != 0);
+      }
+    }
+  }
+
+  void BM_SetActiveAspectRatio(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        g_eeprom->SetActiveAspectRatio((j & 1) ? EEasyXB::AspectRatio::WIDESCREEN : EEasyXB::AspectRatio::NORMAL);
+      }
+    }
+  }
+
+  void BM_SetAudioModeEnabled(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        g_eeprom->SetAudioModeEnabled(EEasyXB::AudioMode::DTS, (j & 1) != 0);
+      }
+    }
+  }
+
+  void BM_CalculateChecksum(unsigned long long iterations)
+  {
+    for(unsigned long long i = 0; i < iterations; ++i)
+    {
+      for(unsigned int j = 0; j < CALLS_PER_ITERATION; ++j)
+      {
+        DoNotOptimize(g_image);
+        DoNotOptimize(EEasyXB::Checksum::Calculate((const unsigned char*)&(g_image.timeZoneBias),
+                                                   EEasyXB::Checksum::USER_SECTION_LENGTH));
+      }
+    }
+  }
+
+  const Benchmark BENCHMARKS[] =
+  {
+    { "IsResolutionEnabled", BM_IsResolutionEnabled },
+    { "IsAudioModeEnabled", BM_IsAudioModeEnabled },
+    { "GetActiveAspectRatio", BM_GetActiveAspectRatio },
+    { "SetResolutionEnabled", BM_SetResolutionEnabled },
+    { "SetActiveAspectRatio", BM_SetActiveAspectRatio },
+    { "SetAudioModeEnabled", BM_SetAudioModeEnabled },
+    { "CalculateChecksum", BM_CalculateChecksum }
+  };
+
+  const unsigned int BENCHMARK_COUNT = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+  const unsigned int REPETITIONS = 15;
+  const double MIN_RUN_SECONDS = 0.05;
+
+  // Defaults for the regression threshold, see main()
+  const double DEFAULT_TOLERANCE = 0.10;
+  const double DEFAULT_NOISE_FACTOR = 3.0;
+  const double DEFAULT_MAX_ALLOWED = 0.25;
+
+  struct Result
+  {
+    double nanoseconds;   // median per call
+    double noise;         // median absolute deviation per call
+  };
+
+  double RunSeconds(BenchmarkFunction function, unsigned long long iterations)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function(iterations);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  // Grows the iteration count until a run is long enough to time
+  unsigned long long Calibrate(BenchmarkFunction function)
+  {
+    unsigned long long iterations = 64;
+    while(RunSeconds(function, iterations) < MIN_RUN_SECONDS)
+    {
+      iterations *= 2;
+    }
+
+    return iterations;
+  }
+
+  double Median(std::vector<double> values)
+  {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+  }
+
+  // Repetitions take turns across benchmarks, so a slow period on
+  // the machine lands on one repetition of several benchmarks
+  // instead of every repetition of one. The median then drops it,
+  // and the spread around the median measures the noise.
+  void MeasureAll(Result* outResults)
+  {
+    unsigned long long iterations[BENCHMARK_COUNT];
+    std::vector<double> samples[BENCHMARK_COUNT];
+
+    for(unsigned int i = 0; i < BENCHMARK_COUNT; ++i)
+    {
+      iterations[i] = Calibrate(BENCHMARKS[i].function);
+
+      // Warm up caches and clocks before the timed runs
+      RunSeconds(BENCHMARKS[i].function, iterations[i]);
+    }
+
+    for(unsigned int repetition = 0; repetition < REPETITIONS; ++repetition)
+    {
+      for(unsigned int i = 0; i < BENCHMARK_COUNT; ++i)
+      {
+        double seconds = RunSeconds(BENCHMARKS[i].function, iterations[i]);
+        samples[i].push_back(seconds * 1e9 / (double)(iterations[i] * CALLS_PER_ITERATION));
+      }
+    }
+
+    for(unsigned int i = 0; i < BENCHMARK_COUNT; ++i)
+    {
+      double median = Median(samples[i]);
+
+      std::vector<double> deviations;
+      for(unsigned int j = 0; j < samples[i].size(); ++j)
+      {
+        deviations.push_back(samples[i][j] > median ? samples[i][j] - median : median - samples[i][j]);
+      }
+
+      outResults[i].nanoseconds = median;
+      outResults[i].noise = Median(deviations);
+    }
+  }
+
+  // Reads "name nanoseconds [noise]" lines, older baselines have
+  // no noise column.
+  bool LoadBaseline(const char* path, std::map<std::string, Result>& outBaseline)
+  {
+    FILE* file = fopen(path, "r");
+    if(!file)
+    {
+      return false;
+    }
+
+    char line[256];
+    while(fgets(line, sizeof(line), file))
+    {
+      char name[128];
+      Result result;
+      result.noise = 0.0;
+
+      if(sscanf(line, "%127s %lf %lf", name, &result.nanoseconds, &result.noise) >= 2)
+      {
+        outBaseline[name] = result;
+      }
+    }
+
+    fclose(file);
+    return true;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* baselinePath = NULL;
+  bool updateBaseline = false;
+  double tolerance = DEFAULT_TOLERANCE;
+  double noiseFactor = DEFAULT_NOISE_FACTOR;
+  double maxAllowed = DEFAULT_MAX_ALLOWED;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if(strncmp(argv[i], "--baseline=", 11) == 0)
+    {
+      baselinePath = argv[i] + 11;
+    }
+    else if(strcmp(argv[i], "--update") == 0)
+    {
+      updateBaseline = true;
+    }
+    else if(strncmp(argv[i], "--tolerance=", 12) == 0)
+    {
+      tolerance = atof(argv[i] + 12);
+    }
+    else if(strncmp(argv[i], "--noise-factor=", 15) == 0)
+    {
+      noiseFactor = atof(argv[i] + 15);
+    }
+    else if(strncmp(argv[i], "--max-allowed=", 14) == 0)
+    {
+      maxAllowed = atof(argv[i] + 14);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--baseline=FILE [--update | --tolerance=FRACTION --noise-factor=N "
+              "--max-allowed=FRACTION]]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  // Start from a realistic image behind the emulated eeprom
+  EEasyXB::CorpusGenerator(1).Generate(0, g_image);
+
+  EEasyXB::NvSettingsEmulator emulator;
+  emulator.SetImage(g_image);
+  emulator.Activate();
+
+  g_eeprom = EEasyXB::Eeprom::GetInstance();
+  if(!g_eeprom->Init(true))
+  {
+    fprintf(stderr, "Failed to read the emulated eeprom\n");
+    return 2;
+  }
+
+  std::map<std::string, Result> baseline;
+  bool compare = (baselinePath != NULL && !updateBaseline);
+  if(compare && !LoadBaseline(baselinePath, baseline))
+  {
+    fprintf(stderr, "Failed to read baseline %s\n", baselinePath);
+    return 2;
+  }
+
+  FILE* output = NULL;
+  if(updateBaseline)
+  {
+    output = fopen(baselinePath, "w");
+    if(!output)
+    {
+      fprintf(stderr, "Failed to write baseline %s\n", baselinePath);
+      return 2;
+    }
+  }
+
+  Result results[BENCHMARK_COUNT];
+  MeasureAll(results);
+
+  unsigned int regressions = 0;
+  unsigned int missing = 0;
+  printf("%-24s %12s %10s %12s %8s %8s\n", "benchmark", "ns/op", "noise", "baseline", "change", "allowed");
+
+  for(unsigned int i = 0; i < BENCHMARK_COUNT; ++i)
+  {
+    const Benchmark& benchmark = BENCHMARKS[i];
+    const Result& result = results[i];
+
+    if(output)
+    {
+      fprintf(output, "%s %.4f %.4f\n", benchmark.name, result.nanoseconds, result.noise);
+    }
+
+    if(!compare)
+    {
+      printf("%-24s %12.3f %10.3f %12s %8s %8s\n", benchmark.name, result.nanoseconds, result.noise, "-", "-", "-");
+      continue;
+    }
+
+    std::map<std::string, Result>::const_iterator previous = baseline.find(benchmark.name);
+    if(previous == baseline.end() || previous->second.nanoseconds <= 0.0)
+    {
+      missing++;
+      printf("%-24s %12.3f %10.3f %12s %8s %8s  MISSING FROM BASELINE\n", benchmark.name, result.nanoseconds,
+             result.noise, "-", "-", "-");
+      continue;
+    }
+
+    // Benchmarks whose baseline was noisy get a wider threshold
+    // than the tolerance, up to maxAllowed. Only the baseline noise
+    // counts, so a noisy current run cannot widen its own threshold.
+    const Result& old = previous->second;
+    double change = (result.nanoseconds - old.nanoseconds) / old.nanoseconds;
+    double allowed = std::min(std::max(tolerance, noiseFactor * old.noise / old.nanoseconds),
+                              std::max(tolerance, maxAllowed));
+    bool regressed = change > allowed;
+    regressions += regressed ? 1 : 0;
+
+    printf("%-24s %12.3f %10.3f %12.3f %+7.1f%% %7.1f%%%s\n", benchmark.name, result.nanoseconds, result.noise,
+           old.nanoseconds, change * 100.0, allowed * 100.0, regressed ? "  REGRESSION" : "");
+  }
+
+  if(output && fclose(output) != 0)
+  {
+    fprintf(stderr, "Failed to write baseline %s\n", baselinePath);
+    return 2;
+  }
+
+  if(missing != 0)
+  {
+    printf("\n%u benchmark(s) missing from the baseline, run make baseline\n", missing);
+  }
+  if(regressions != 0)
+  {
+    printf("\n%u benchmark(s) slower than the baseline by more than the allowed change\n", regressions);
+  }
+  if(missing != 0 || regressions != 0)
+  {
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,578 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// End to end checks of Eeprom against the NV settings emulator,
+// and round trip checks of the host tooling. Each check starts from
+// a fresh emulated console and a shut down Eeprom, so checks do not
+// depend on each other.
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "Checksum.h"
+#include "CorpusGenerator.h"
+#include "Eeprom.h"
+#include "EepromPackReader.h"
+#include "EepromPackWriter.h"
+#include "History.h"
+#include "NetworkProvisioner.h"
+#include "NvSettingsEmulator.h"
+#include "ParentalControl.h"
+#include "Serializer.h"
+#include "UnitIndex.h"
+
+namespace
+{
+  typedef bool (*CheckFunction)(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom);
+
+  struct Check
+  {
+    const char* name;
+    CheckFunction function;
+  };
+
+  bool CheckWriteStoresValidChecksums(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    if(!eeprom.Read())
+    {
+      return false;
+    }
+
+    EEasyXB::AspectRatio aspectRatio = (eeprom.GetActiveAspectRatio() == EEasyXB::AspectRatio::WIDESCREEN) ?
+                                       EEasyXB::AspectRatio::LETTERBOX : EEasyXB::AspectRatio::WIDESCREEN;
+    eeprom.SetActiveAspectRatio(aspectRatio);
+    eeprom.SetIpAddress(EEasyXB::IpAddress::Make(192, 168, 1, 50));
+
+    if(!eeprom.Write())
+    {
+      return false;
+    }
+
+    EEasyXB::EepromData stored = emulator.GetImage();
+    if(emulator.GetWriteCount() != 1 ||
+       !EEasyXB::Checksum::IsFactoryValid(stored) ||
+       !EEasyXB::Checksum::IsUserValid(stored))
+    {
+      return false;
+    }
+
+    // Read the stored image back through a fresh instance
+    eeprom.Shutdown();
+    return eeprom.Init(true) &&
+           eeprom.GetActiveAspectRatio() == aspectRatio &&
+           eeprom.GetIpAddress() == EEasyXB::IpAddress::Make(192, 168, 1, 50);
+  }
+
+  bool CheckFailedReadIsReported(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    emulator.FailNext(1, 0);
+    return !eeprom.Read() && eeprom.Read();
+  }
+
+  bool CheckFailedWriteLeavesImage(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    EEasyXB::EepromData original = emulator.GetImage();
+    if(!eeprom.Read())
+    {
+      return false;
+    }
+
+    eeprom.SetGateway(EEasyXB::IpAddress::Make(10, 0, 0, 1));
+    emulator.FailNext(0, 1);
+
+    EEasyXB::EepromData stored = emulator.GetImage();
+    return !eeprom.Write() &&
+           emulator.GetWriteCount() == 0 &&
+           memcmp(&stored, &original, sizeof(original)) == 0;
+  }
+
+  bool CheckCorruptChecksumIsReported(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    EEasyXB::EepromData corrupt = emulator.GetImage();
+    corrupt.userChecksum ^= 0x00000100;
+    emulator.SetImage(corrupt);
+
+    if(!eeprom.Read() || !eeprom.IsFactoryChecksumValid() || eeprom.IsUserChecksumValid())
+    {
+      return false;
+    }
+
+    // Written back as read, not silently repaired
+    if(!eeprom.Write())
+    {
+      return false;
+    }
+
+    EEasyXB::EepromData stored = emulator.GetImage();
+    return emulator.GetWriteCount() == 1 &&
+           memcmp(&stored, &corrupt, sizeof(corrupt)) == 0;
+  }
+
+  bool CheckHistoryIsFormattedOnlyOnRequest(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    EEasyXB::EepromData image = emulator.GetImage();
+    memset(image.history, 0x5A, sizeof(image.history));
+    emulator.SetImage(image);
+
+    EEasyXB::HistoryEntry entry = { 1, 42 };
+    if(!eeprom.Read() || eeprom.AppendHistoryEntry(entry) || !eeprom.Write())
+    {
+      return false;
+    }
+
+    // Unknown contents survive a write
+    EEasyXB::EepromData stored = emulator.GetImage();
+    if(memcmp(stored.history, image.history, sizeof(image.history)) != 0)
+    {
+      return false;
+    }
+
+    // A header whose next slot does not follow its count before
+    // the ring wraps is not taken as formatted
+    EEasyXB::History::Format(image);
+    unsigned int header;
+    memcpy(&header, image.history, sizeof(header));
+    header = (header & 0xFFFF) | (5 << 16) | (2 << 24);
+    memcpy(image.history, &header, sizeof(header));
+    if(EEasyXB::History::IsFormatted(image))
+    {
+      return false;
+    }
+
+    EEasyXB::HistoryEntry read;
+    return eeprom.FormatHistory() &&
+           eeprom.AppendHistoryEntry(entry) &&
+           eeprom.GetHistoryCount() == 1 &&
+           eeprom.GetHistoryEntry(0, read) &&
+           read.ToRaw() == entry.ToRaw();
+  }
+
+  bool CheckWriteRequiresRead(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    EEasyXB::EepromData original = emulator.GetImage();
+
+    // Neither before the first read nor after Shutdown()
+    bool refused = !eeprom.Write();
+    if(!eeprom.Read())
+    {
+      return false;
+    }
+    eeprom.Shutdown();
+    refused = refused && !eeprom.Write();
+
+    EEasyXB::EepromData stored = emulator.GetImage();
+    return refused &&
+           emulator.GetWriteCount() == 0 &&
+           memcmp(&stored, &original, sizeof(original)) == 0;
+  }
+
+  bool CheckEasternDaylightTime(EEasyXB::NvSettingsEmulator& emulator, EEasyXB::Eeprom& eeprom)
+  {
+    if(!eeprom.Read())
+    {
+      return false;
+    }
+
+    // US Eastern: daylight time from the second Sunday in March to
+    // the first Sunday in November, both at 2:00 local
+    EEasyXB::TimeZoneDate daylightStart = { 3, 2, 0, 2 };
+    EEasyXB::TimeZoneDate standardStart = { 11, 1, 0, 2 };
+    eeprom.SetTimeZoneBias(300);
+    eeprom.SetTimeZoneStandardBias(0);
+    eeprom.SetTimeZoneDaylightBias(-60);
+    eeprom.SetTimeZoneDaylightStart(daylightStart);
+    eeprom.SetTimeZoneStandardStart(standardStart);
+
+    if(!eeprom.Write() || !EEasyXB::Checksum::IsUserValid(emulator.GetImage()))
+    {
+      return false;
+    }
+
+    // 2021-07-01 and 2021-01-15, both 12:00
+    const long long july = 1625140800;
+    const long long january = 1610712000;
+
+    EEasyXB::TimeZone timeZone(emulator.GetImage());
+    return timeZone.IsDaylightTime(july) &&
+           timeZone.LocalToUtc(july) == july + 4 * 3600 &&
+           timeZone.UtcToLocal(july + 4 * 3600) == july &&
+           !timeZone.IsDaylightTime(january) &&
+           timeZone.LocalToUtc(january) == january + 5 * 3600 &&
+           timeZone.UtcToLocal(january + 5 * 3600) == january;
+  }
+
+  bool CheckProvisionSkipsUnusableAddresses(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    // A range that starts on a network address and crosses into
+    // the next /24 subnet
+    EEasyXB::AddressPlan plan;
+    plan.firstAddress = EEasyXB::IpAddress::Make(192, 168, 1, 0);
+    plan.lastAddress = EEasyXB::IpAddress::Make(192, 168, 2, 2);
+    plan.subnetMask = EEasyXB::IpAddress::Make(255, 255, 255, 0);
+    plan.gateway = EEasyXB::IpAddress::Make(192, 168, 1, 1);
+    plan.dnsServer = EEasyXB::IpAddress::Make(192, 168, 1, 3);
+
+    EEasyXB::NetworkProvisioner provisioner(plan);
+    provisioner.Reserve(EEasyXB::IpAddress::Make(192, 168, 1, 5));
+
+    // Everything in the range except 1.0, 1.1, 1.3, 1.5, 1.255
+    // and 2.0
+    const unsigned int usable = 253;
+    std::vector<EEasyXB::EepromData> images(usable + 1);
+    EEasyXB::CorpusGenerator(13).Generate(0, usable + 1, images.data());
+
+    if(!provisioner.Provision(images.data(), usable) ||
+       provisioner.Provision(images.data() + usable, 1) ||
+       provisioner.GetCollisionCount() != 3)
+    {
+      return false;
+    }
+
+    for(unsigned int i = 0; i < usable; ++i)
+    {
+      const EEasyXB::EepromData& image = images[i];
+      unsigned char host = EEasyXB::IpAddress::GetOctet(image.liveIp, 3);
+
+      if(host == 0 || host == 255 || image.liveIp == plan.gateway || image.liveIp == plan.dnsServer ||
+         image.liveIp == EEasyXB::IpAddress::Make(192, 168, 1, 5) ||
+         image.liveSubnet != plan.subnetMask || image.liveGateway != plan.gateway ||
+         image.liveDns != plan.dnsServer || !EEasyXB::Checksum::IsUserValid(image))
+      {
+        return false;
+      }
+    }
+
+    unsigned int collision;
+    return EEasyXB::NetworkProvisioner::FindCollisions(images.data(), usable, &collision, 1) == 0;
+  }
+
+  const char* const SCRATCH_PATH = "eeasyxb_checks.tmp";
+
+  bool CheckPackRoundTrip(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    // Enough images for several blocks, the last one partial
+    const unsigned int count = 1000;
+    std::vector<EEasyXB::EepromData> images(count);
+    EEasyXB::CorpusGenerator(7).Generate(0, count, images.data());
+
+    EEasyXB::EepromData base;
+    EEasyXB::EepromPackWriter::ComputeBase(images.data(), count, base);
+
+    EEasyXB::EepromPackWriter writer;
+    if(!writer.Open(SCRATCH_PATH, base, 64))
+    {
+      return false;
+    }
+    for(unsigned int i = 0; i < count; ++i)
+    {
+      writer.Append(images[i]);
+    }
+    if(!writer.Close())
+    {
+      return false;
+    }
+
+    EEasyXB::EepromPackReader reader;
+    bool success = reader.Open(SCRATCH_PATH) && reader.GetCount() == count;
+
+    EEasyXB::EepromData image;
+    for(unsigned int i = 0; i < count && success; ++i)
+    {
+      success = reader.Next(image) && memcmp(&image, &images[i], sizeof(image)) == 0;
+    }
+    success = success && !reader.Next(image);
+
+    // Backwards and across blocks
+    for(unsigned int i = 0; i < count && success; i += 37)
+    {
+      unsigned int index = count - 1 - i;
+      success = reader.Read(index, image) && memcmp(&image, &images[index], sizeof(image)) == 0;
+    }
+
+    reader.Close();
+    remove(SCRATCH_PATH);
+    return success;
+  }
+
+  // Every image is found by serial and by MAC, with its offset
+  bool IsIndexComplete(const EEasyXB::UnitIndex& index, const std::vector<EEasyXB::EepromData>& images)
+  {
+    for(unsigned int i = 0; i < images.size(); ++i)
+    {
+      const EEasyXB::UnitIndexEntry* bySerial[4];
+      const EEasyXB::UnitIndexEntry* byMac[4];
+      unsigned int serialMatches = index.FindBySerial(images[i].serial, bySerial, 4);
+      unsigned int macMatches = index.FindByMac(images[i].macAddress, byMac, 4);
+
+      if(serialMatches != 1 || macMatches != 1 || bySerial[0] != byMac[0] ||
+         bySerial[0]->archiveId != 1 || bySerial[0]->GetOffset() != i * sizeof(EEasyXB::EepromData))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool CheckIndexRoundTrip(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    // Enough images for the side table to be merged a few times
+    const unsigned int count = 2000;
+    std::vector<EEasyXB::EepromData> images(count);
+    EEasyXB::CorpusGenerator(11).Generate(0, count, images.data());
+
+    EEasyXB::UnitIndex index;
+    for(unsigned int i = 0; i < count - 1; ++i)
+    {
+      index.Add(images[i], 1, i * sizeof(EEasyXB::EepromData));
+    }
+    if(!index.Save(SCRATCH_PATH))
+    {
+      return false;
+    }
+
+    images.pop_back();
+    EEasyXB::UnitIndex loaded;
+    bool success = IsIndexComplete(index, images) &&
+                   loaded.Load(SCRATCH_PATH) &&
+                   loaded.GetCount() == count - 1 &&
+                   IsIndexComplete(loaded, images);
+
+    // Attach a copy of the file, 4 byte aligned
+    std::vector<unsigned int> file;
+    FILE* stream = fopen(SCRATCH_PATH, "rb");
+    if(stream)
+    {
+      fseek(stream, 0, SEEK_END);
+      long size = ftell(stream);
+      fseek(stream, 0, SEEK_SET);
+      file.resize((size + 3) / 4);
+      success = success && fread(file.data(), 1, size, stream) == (size_t)size;
+      fclose(stream);
+    }
+    remove(SCRATCH_PATH);
+
+    EEasyXB::UnitIndex attached;
+    success = success &&
+              attached.Attach(file.data(), file.size() * 4) &&
+              IsIndexComplete(attached, images);
+
+    // Found straight after an Add, before any merge
+    EEasyXB::EepromData last;
+    EEasyXB::CorpusGenerator(11).Generate(count - 1, last);
+    images.push_back(last);
+    attached.Add(last, 1, (count - 1) * sizeof(EEasyXB::EepromData));
+    success = success && attached.GetCount() == count && IsIndexComplete(attached, images);
+
+    // Swapping two entries breaks the serial order
+    if(success)
+    {
+      EEasyXB::UnitIndexEntry* entries = (EEasyXB::UnitIndexEntry*)(file.data() + 4);
+      std::swap(entries[0], entries[1]);
+      EEasyXB::UnitIndex unsorted;
+      success = !unsorted.Attach(file.data(), file.size() * 4);
+    }
+
+    return success;
+  }
+
+  bool CheckPasscodeRoundTrip(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    const unsigned int length = EEasyXB::ParentalControl::PASSCODE_LENGTH;
+    const unsigned int buttonCount = EEasyXB::PASSCODE_RIGHT_TRIGGER + 1;
+
+    // Every combination of buttons, including unset ones
+    unsigned int combinations = 1;
+    for(unsigned int i = 0; i < length; ++i)
+    {
+      combinations *= buttonCount;
+    }
+
+    for(unsigned int combination = 0; combination < combinations; ++combination)
+    {
+      EEasyXB::PasscodeButton buttons[length];
+      unsigned int remaining = combination;
+      for(unsigned int i = 0; i < length; ++i)
+      {
+        buttons[i] = (EEasyXB::PasscodeButton)(remaining % buttonCount);
+        remaining /= buttonCount;
+      }
+
+      unsigned int rawPasscode = EEasyXB::ParentalControl::EncodePasscode(buttons);
+      EEasyXB::PasscodeButton decoded[length];
+      bool isSet = EEasyXB::ParentalControl::DecodePasscode(rawPasscode, decoded);
+
+      if(isSet != (combination != 0) || memcmp(decoded, buttons, sizeof(buttons)) != 0)
+      {
+        return false;
+      }
+    }
+
+    // The first button is in the most significant nibble
+    EEasyXB::PasscodeButton buttons[length] =
+    {
+      EEasyXB::PASSCODE_X, EEasyXB::PASSCODE_Y, EEasyXB::PASSCODE_DPAD_UP, EEasyXB::PASSCODE_NONE
+    };
+    return EEasyXB::ParentalControl::EncodePasscode(buttons) == 0x5610;
+  }
+
+  bool CheckSerializerRoundTrip(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    const unsigned int count = 500;
+    std::vector<EEasyXB::EepromData> images(count);
+    EEasyXB::CorpusGenerator(17).Generate(0, count, images.data());
+
+    // Bytes outside the known fields and a bad checksum survive too
+    memset(images[0].history, 0xA5, sizeof(images[0].history));
+    images[1].userChecksum ^= 1;
+
+    char json[EEasyXB::Serializer::MAX_JSON_SIZE];
+    unsigned char record[EEasyXB::Serializer::BINARY_RECORD_SIZE];
+
+    for(unsigned int i = 0; i < count; ++i)
+    {
+      EEasyXB::EepromData fromJson;
+      EEasyXB::EepromData fromBinary;
+      unsigned int length = EEasyXB::Serializer::ToJson(images[i], json, sizeof(json));
+      bool factoryValid, userValid;
+
+      if(length == 0 ||
+         !EEasyXB::Serializer::FromJson(json, length, fromJson) ||
+         memcmp(&fromJson, &images[i], sizeof(fromJson)) != 0 ||
+         EEasyXB::Serializer::ToBinary(images[i], record, sizeof(record)) != sizeof(record) ||
+         !EEasyXB::Serializer::FromBinary(record, sizeof(record), fromBinary) ||
+         memcmp(&fromBinary, &images[i], sizeof(fromBinary)) != 0 ||
+         !EEasyXB::Serializer::GetBinaryChecksumStatus(record, &factoryValid, &userValid) ||
+         !factoryValid || userValid != (i != 1))
+      {
+        return false;
+      }
+    }
+
+    // Truncated input is refused
+    EEasyXB::EepromData image;
+    unsigned int length = EEasyXB::Serializer::ToJson(images[0], json, sizeof(json));
+    return !EEasyXB::Serializer::FromJson(json, length / 2, image) &&
+           !EEasyXB::Serializer::FromBinary(record, sizeof(record) - 1, image);
+  }
+
+  bool SerialLess(const EEasyXB::EepromData& left, const EEasyXB::EepromData& right)
+  {
+    return memcmp(left.serial, right.serial, sizeof(left.serial)) < 0;
+  }
+
+  bool MacLess(const EEasyXB::EepromData& left, const EEasyXB::EepromData& right)
+  {
+    return memcmp(left.macAddress, right.macAddress, sizeof(left.macAddress)) < 0;
+  }
+
+  bool CheckGeneratedImagesAreValid(EEasyXB::NvSettingsEmulator&, EEasyXB::Eeprom&)
+  {
+    const unsigned int count = 20000;
+    const unsigned int first = 1000;
+    std::vector<EEasyXB::EepromData> images(count);
+    EEasyXB::CorpusGenerator generator(19);
+    generator.Generate(first, count, images.data());
+
+    for(unsigned int i = 0; i < count; ++i)
+    {
+      // A range matches the same images generated one at a time
+      EEasyXB::EepromData single;
+      generator.Generate(first + i, single);
+
+      if(memcmp(&single, &images[i], sizeof(single)) != 0 ||
+         !EEasyXB::Checksum::IsFactoryValid(images[i]) ||
+         !EEasyXB::Checksum::IsUserValid(images[i]))
+      {
+        return false;
+      }
+    }
+
+    std::sort(images.begin(), images.end(), SerialLess);
+    for(unsigned int i = 1; i < count; ++i)
+    {
+      if(!SerialLess(images[i - 1], images[i]))
+      {
+        return false;
+      }
+    }
+
+    std::sort(images.begin(), images.end(), MacLess);
+    for(unsigned int i = 1; i < count; ++i)
+    {
+      if(!MacLess(images[i - 1], images[i]))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  const Check CHECKS[] =
+  {
+    { "WriteStoresValidChecksums", CheckWriteStoresValidChecksums },
+    { "FailedReadIsReported", CheckFailedReadIsReported },
+    { "FailedWriteLeavesImage", CheckFailedWriteLeavesImage },
+    { "CorruptChecksumIsReported", CheckCorruptChecksumIsReported },
+    { "HistoryIsFormattedOnlyOnRequest", CheckHistoryIsFormattedOnlyOnRequest },
+    { "WriteRequiresRead", CheckWriteRequiresRead },
+    { "EasternDaylightTime", CheckEasternDaylightTime },
+    { "ProvisionSkipsUnusableAddresses", CheckProvisionSkipsUnusableAddresses },
+    { "PackRoundTrip", CheckPackRoundTrip },
+    { "IndexRoundTrip", CheckIndexRoundTrip },
+    { "PasscodeRoundTrip", CheckPasscodeRoundTrip },
+    { "SerializerRoundTrip", CheckSerializerRoundTrip },
+    { "GeneratedImagesAreValid", CheckGeneratedImagesAreValid }
+  };
+}
+
+int main()
+{
+  EEasyXB::CorpusGenerator generator(1);
+  EEasyXB::Eeprom* eeprom = EEasyXB::Eeprom::GetInstance();
+  unsigned int failures = 0;
+
+  for(unsigned int i = 0; i < sizeof(CHECKS) / sizeof(CHECKS[0]); ++i)
+  {
+    const Check& check = CHECKS[i];
+
+    EEasyXB::EepromData image;
+    generator.Generate(i, image);
+
+    EEasyXB::NvSettingsEmulator emulator;
+    emulator.SetImage(image);
+    emulator.Activate();
+
+    eeprom->Shutdown();
+    eeprom->Init();
+
+    bool passed = check.function(emulator, *eeprom);
+    failures += passed ? 0 : 1;
+    printf("%-32s %s\n", check.name, passed ? "PASS" : "FAIL");
+
+    EEasyXB::NvSettingsEmulator::Deactivate();
+  }
+
+  eeprom->Shutdown();
+
+  if(failures != 0)
+  {
+    printf("\n%u check(s) failed\n", failures);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,262 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "NvSettingsEmulator.h"
+#include <xboxkrnl/xboxkrnl.h>
+
+#include <chrono>
+#include <string.h>
+#include <thread>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        // Value index used for the whole eeprom
+        const ULONG EEPROM_INDEX = 0xFFFF;
+
+        thread_local NvSettingsEmulator* t_active = NULL;
+
+        unsigned long long RateToThreshold(float rate)
+        {
+            if(rate <= 0.0f)
+            {
+                return 0;
+            }
+            if(rate >= 1.0f)
+            {
+                return 0x100000000ULL;
+            }
+            return (unsigned long long)(rate * 4294967296.0);
+        }
+    }
+
+    NvSettingsEmulator::NvSettingsEmulator()
+        : m_latency(0),
+          m_readFailureThreshold(0),
+          m_writeFailureThreshold(0),
+          m_random(1),
+          m_forcedReadFailures(0),
+          m_forcedWriteFailures(0),
+          m_readCount(0),
+          m_writeCount(0)
+    {
+        memset(&m_image, 0, sizeof(m_image));
+        memset(m_wear, 0, sizeof(m_wear));
+    }
+
+    void NvSettingsEmulator::Activate()
+    {
+        t_active = this;
+    }
+
+    void NvSettingsEmulator::Deactivate()
+    {
+        t_active = NULL;
+    }
+
+    NvSettingsEmulator* NvSettingsEmulator::GetActive()
+    {
+        return t_active;
+    }
+
+    void NvSettingsEmulator::SetImage(const EepromData& image)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_image = image;
+    }
+
+    EepromData NvSettingsEmulator::GetImage()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_image;
+    }
+
+    void NvSettingsEmulator::SetLatency(unsigned int microseconds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latency = microseconds;
+    }
+
+    void NvSettingsEmulator::SetFailureRate(float readFailureRate, float writeFailureRate, unsigned int seed)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readFailureThreshold = RateToThreshold(readFailureRate);
+        m_writeFailureThreshold = RateToThreshold(writeFailureRate);
+        m_random = (seed != 0) ? seed : 1;
+    }
+
+    void NvSettingsEmulator::FailNext(unsigned int reads, unsigned int writes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_forcedReadFailures = reads;
+        m_forcedWriteFailures = writes;
+    }
+
+    unsigned int NvSettingsEmulator::GetReadCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_readCount;
+    }
+
+    unsigned int NvSettingsEmulator::GetWriteCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_writeCount;
+    }
+
+    unsigned int NvSettingsEmulator::GetWearCount(unsigned int offset)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return (offset < sizeof(EepromData)) ? m_wear[offset] : 0;
+    }
+
+    unsigned int NvSettingsEmulator::GetMaxWearCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        unsigned int maxWear = 0;
+        for(unsigned int i = 0; i < sizeof(EepromData); ++i)
+        {
+            if(m_wear[i] > maxWear)
+            {
+                maxWear = m_wear[i];
+            }
+        }
+
+        return maxWear;
+    }
+
+    long NvSettingsEmulator::Query(void* outData, unsigned long length, unsigned long* outBytesRead)
+    {
+        Delay();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(ShouldFail(m_readFailureThreshold, &m_forcedReadFailures))
+        {
+            return STATUS_IO_DEVICE_ERROR;
+        }
+
+        if(length < sizeof(EepromData))
+        {
+            return STATUS_BUFFER_TOO_SMALL;
+        }
+
+        memcpy(outData, &m_image, sizeof(EepromData));
+        if(outBytesRead)
+        {
+            *outBytesRead = sizeof(EepromData);
+        }
+
+        m_readCount++;
+        return STATUS_SUCCESS;
+    }
+
+    long NvSettingsEmulator::Save(const void* data, unsigned long length)
+    {
+        Delay();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(ShouldFail(m_writeFailureThreshold, &m_forcedWriteFailures))
+        {
+            return STATUS_IO_DEVICE_ERROR;
+        }
+
+        if(length != sizeof(EepromData))
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        const unsigned char* newBytes = (const unsigned char*)data;
+        unsigned char* bytes = (unsigned char*)&m_image;
+        for(unsigned int i = 0; i < sizeof(EepromData); ++i)
+        {
+            if(bytes[i] != newBytes[i])
+            {
+                bytes[i] = newBytes[i];
+                m_wear[i]++;
+            }
+        }
+
+        m_writeCount++;
+        return STATUS_SUCCESS;
+    }
+
+    void NvSettingsEmulator::Delay()
+    {
+        unsigned int latency;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            latency = m_latency;
+        }
+
+        if(latency != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(latency));
+        }
+    }
+
+    bool NvSettingsEmulator::ShouldFail(unsigned long long threshold, unsigned int* forcedFailures)
+    {
+        if(*forcedFailures != 0)
+        {
+            (*forcedFailures)--;
+            return true;
+        }
+
+        if(threshold == 0)
+        {
+            return false;
+        }
+
+        // xorshift32, deterministic for a given seed
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+
+        return (unsigned long long)m_random < threshold;
+    }
+} // namespace EEasyXB
+
+extern "C" NTSTATUS ExQueryNonVolatileSetting(ULONG ValueIndex, PULONG Type, PVOID Value, ULONG ValueLength, PULONG ResultLength)
+{
+    EEasyXB::NvSettingsEmulator* emulator = EEasyXB::NvSettingsEmulator::GetActive();
+
+    if(!emulator || ValueIndex != EEasyXB::EEPROM_INDEX || !Value)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    if(Type)
+    {
+        *Type = 0;
+    }
+
+    return emulator->Query(Value, ValueLength, ResultLength);
+}
+
+extern "C" NTSTATUS ExSaveNonVolatileSetting(ULONG ValueIndex, ULONG Type, PVOID Value, ULONG ValueLength)
+{
+    EEasyXB::NvSettingsEmulator* emulator = EEasyXB::NvSettingsEmulator::GetActive();
+
+    (void)Type;
+
+    if(!emulator || ValueIndex != EEasyXB::EEPROM_INDEX || !Value)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    return emulator->Save(Value, ValueLength);
+}
@@ -0,0 +1,179 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef NV_SETTINGS_EMULATOR_H
+#define NV_SETTINGS_EMULATOR_H
+
+#include <mutex>
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Host side stand-in for the eeprom of one console.
+     * 
+     * Builds that use the Emulator directory in place of NXDK
+     * route ExQueryNonVolatileSetting and ExSaveNonVolatileSetting
+     * to the emulator activated on the calling thread, so each
+     * thread can simulate a different console through those calls.
+     * 
+     * EEasyXB::Eeprom is a single instance per process holding one
+     * image, so only one thread of a process should use it. Once
+     * it has read, its getters return that image no matter which
+     * emulator is active. Simulate consoles in parallel either
+     * with one process per console or by calling the Ex* functions
+     * directly from each thread.
+     * 
+     */
+    class NvSettingsEmulator
+    {
+    public:
+        /**
+         * @brief Construct an emulator with an all zero image,
+         * no latency and no failures.
+         * 
+         */
+        NvSettingsEmulator();
+
+        /**
+         * @brief Make this emulator the one used by kernel calls
+         * made from the calling thread.
+         * 
+         */
+        void Activate();
+
+        /**
+         * @brief Stop routing kernel calls from the calling thread
+         * to any emulator. Calls made afterwards fail.
+         * 
+         */
+        static void Deactivate();
+
+        /**
+         * @brief Get the emulator active on the calling thread.
+         * 
+         * @return NvSettingsEmulator* Active emulator, or NULL.
+         */
+        static NvSettingsEmulator* GetActive();
+
+        /**
+         * @brief Replace the contents of the emulated eeprom.
+         * Does not count towards wear.
+         * 
+         * @param image New contents.
+         */
+        void SetImage(const EepromData& image);
+
+        /**
+         * @brief Get the contents of the emulated eeprom.
+         * 
+         * @return EepromData Current contents.
+         */
+        EepromData GetImage();
+
+        /**
+         * @brief Set the time every read and write takes.
+         * 
+         * @param microseconds Delay added to each call.
+         */
+        void SetLatency(unsigned int microseconds);
+
+        /**
+         * @brief Make a fraction of reads and writes fail.
+         * 
+         * @param readFailureRate Chance from 0 to 1 that a read fails.
+         * @param writeFailureRate Chance from 0 to 1 that a write fails.
+         * @param seed Seed for the failure pattern, so a run can
+         * be repeated.
+         */
+        void SetFailureRate(float readFailureRate, float writeFailureRate, unsigned int seed = 1);
+
+        /**
+         * @brief Make the next reads and writes fail regardless
+         * of the failure rate.
+         * 
+         * @param reads Number of reads to fail.
+         * @param writes Number of writes to fail.
+         */
+        void FailNext(unsigned int reads, unsigned int writes);
+
+        /**
+         * @brief Get the number of successful reads.
+         * 
+         * @return unsigned int Number of reads.
+         */
+        unsigned int GetReadCount();
+
+        /**
+         * @brief Get the number of successful writes.
+         * 
+         * @return unsigned int Number of writes.
+         */
+        unsigned int GetWriteCount();
+
+        /**
+         * @brief Get the number of writes that changed a byte of
+         * the eeprom, a measure of wear on that cell.
+         * 
+         * @param offset Offset of the byte in EepromData.
+         * @return unsigned int Number of times the byte changed.
+         */
+        unsigned int GetWearCount(unsigned int offset);
+
+        /**
+         * @brief Get the highest wear count across all bytes.
+         * 
+         * @return unsigned int Wear count of the most worn byte.
+         */
+        unsigned int GetMaxWearCount();
+
+        /**
+         * @brief Emulate ExQueryNonVolatileSetting for the whole
+         * eeprom.
+         * 
+         * @return long NTSTATUS of the call.
+         */
+        long Query(void* outData, unsigned long length, unsigned long* outBytesRead);
+
+        /**
+         * @brief Emulate ExSaveNonVolatileSetting for the whole
+         * eeprom.
+         * 
+         * @return long NTSTATUS of the call.
+         */
+        long Save(const void* data, unsigned long length);
+
+    private:
+        std::mutex m_mutex;
+        EepromData m_image;
+        unsigned int m_latency;
+        unsigned long long m_readFailureThreshold;  // fail when random value is below
+        unsigned long long m_writeFailureThreshold;
+        unsigned int m_random;
+        unsigned int m_forcedReadFailures;
+        unsigned int m_forcedWriteFailures;
+        unsigned int m_readCount;
+        unsigned int m_writeCount;
+        unsigned int m_wear[sizeof(EepromData)];
+
+        void Delay();
+        bool ShouldFail(unsigned long long threshold, unsigned int* forcedFailures);
+
+        // Not copyable, holds a mutex
+        NvSettingsEmulator(const NvSettingsEmulator& copy);
+        NvSettingsEmulator& operator=(const NvSettingsEmulator& copy);
+    };
+} // namespace EEasyXB
+
+#endif // NV_SETTINGS_EMULATOR_H
@@ -0,0 +1,42 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Host stand-in for the NXDK kernel header. Declares only the
+// parts of the kernel API used by EEasyXB, which are implemented
+// by NvSettingsEmulator.cpp.
+
+#ifndef EEASYXB_EMULATOR_XBOXKRNL_H
+#define EEASYXB_EMULATOR_XBOXKRNL_H
+
+typedef long NTSTATUS;
+typedef unsigned long ULONG;
+typedef unsigned long* PULONG;
+typedef void* PVOID;
+
+#define STATUS_SUCCESS              ((NTSTATUS)0x00000000L)
+#define STATUS_IO_DEVICE_ERROR      ((NTSTATUS)0xC0000185L)
+#define STATUS_INVALID_PARAMETER    ((NTSTATUS)0xC000000DL)
+#define STATUS_BUFFER_TOO_SMALL     ((NTSTATUS)0xC0000023L)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NTSTATUS ExQueryNonVolatileSetting(ULONG ValueIndex, PULONG Type, PVOID Value, ULONG ValueLength, PULONG ResultLength);
+NTSTATUS ExSaveNonVolatileSetting(ULONG ValueIndex, ULONG Type, PVOID Value, ULONG ValueLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EEASYXB_EMULATOR_XBOXKRNL_H
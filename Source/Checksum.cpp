@@ -0,0 +1,65 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Checksum algorithm based on code written by Ernegien
+// https://github.com/Ernegien/nxdk/commit/62bc74fa95a79724ff07688e70d44f5be0afeb3a
+
+#include "Checksum.h"
+
+namespace EEasyXB
+{
+    unsigned int Checksum::Calculate(const unsigned char* data, unsigned int length)
+    {
+        return FromSum(Sum(data, length));
+    }
+
+    unsigned long long Checksum::Sum(const unsigned char* data, unsigned int length)
+    {
+        unsigned long long sum = 0;
+
+        for (unsigned int i = 0; i < length / sizeof(unsigned int); i++)
+        {
+            sum += ((const unsigned int*)data)[i];
+        }
+
+        return sum;
+    }
+
+    unsigned int Checksum::FromSum(unsigned long long sum)
+    {
+        unsigned int high = (unsigned int)(sum >> 32);
+        unsigned int low = (unsigned int)sum;
+
+        return ~(high + low);
+    }
+
+    void Checksum::UpdateFactory(EepromData& data)
+    {
+        data.factoryChecksum = Calculate((const unsigned char*)&(data.serial), FACTORY_SECTION_LENGTH);
+    }
+
+    void Checksum::UpdateUser(EepromData& data)
+    {
+        data.userChecksum = Calculate((const unsigned char*)&(data.timeZoneBias), USER_SECTION_LENGTH);
+    }
+
+    bool Checksum::IsFactoryValid(const EepromData& data)
+    {
+        return (data.factoryChecksum == Calculate((const unsigned char*)&(data.serial), FACTORY_SECTION_LENGTH));
+    }
+
+    bool Checksum::IsUserValid(const EepromData& data)
+    {
+        return (data.userChecksum == Calculate((const unsigned char*)&(data.timeZoneBias), USER_SECTION_LENGTH));
+    }
+} // namespace EEasyXB
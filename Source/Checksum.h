@@ -0,0 +1,102 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Checksum algorithm based on code written by Ernegien
+// https://github.com/Ernegien/nxdk/commit/62bc74fa95a79724ff07688e70d44f5be0afeb3a
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Helpers for computing and validating the factory
+     * and user section checksums of an eeprom image.
+     * 
+     */
+    class Checksum
+    {
+    public:
+        /**
+         * @brief Calculate the checksum of a block of 32 bit words.
+         * 
+         * @param data Start of the block.
+         * @param length Length of the block in bytes.
+         * @return unsigned int Checksum of the block.
+         */
+        static unsigned int Calculate(const unsigned char* data, unsigned int length);
+
+        /**
+         * @brief Calculate the 64 bit sum of a block of 32 bit words
+         * that the checksum is derived from. Keeping this sum lets a
+         * checksum be updated when one word changes without summing
+         * the block again.
+         * 
+         * @param data Start of the block.
+         * @param length Length of the block in bytes.
+         * @return unsigned long long Sum of the words in the block.
+         */
+        static unsigned long long Sum(const unsigned char* data, unsigned int length);
+
+        /**
+         * @brief Derive a checksum from the sum of its block.
+         * 
+         * @param sum Value returned by Sum(), adjusted by the old
+         * and new values of any words changed since.
+         * @return unsigned int Checksum of the block.
+         */
+        static unsigned int FromSum(unsigned long long sum);
+
+        /**
+         * @brief Recalculate the factory section checksum of an image.
+         * 
+         * @param data Image to update.
+         */
+        static void UpdateFactory(EepromData& data);
+
+        /**
+         * @brief Recalculate the user section checksum of an image.
+         * 
+         * @param data Image to update.
+         */
+        static void UpdateUser(EepromData& data);
+
+        /**
+         * @brief Checks to see if the factory section checksum of
+         * an image is valid.
+         * 
+         * @param data Image to check.
+         * @return true If the stored checksum matches the data.
+         * @return false Otherwise.
+         */
+        static bool IsFactoryValid(const EepromData& data);
+
+        /**
+         * @brief Checks to see if the user section checksum of
+         * an image is valid.
+         * 
+         * @param data Image to check.
+         * @return true If the stored checksum matches the data.
+         * @return false Otherwise.
+         */
+        static bool IsUserValid(const EepromData& data);
+
+        // Size in bytes of the data covered by each checksum
+        static const unsigned int FACTORY_SECTION_LENGTH = 0x2C;
+        static const unsigned int USER_SECTION_LENGTH = 0x5C;
+    };
+} // namespace EEasyXB
+
+#endif // CHECKSUM_H
@@ -0,0 +1,384 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "CorpusGenerator.h"
+#include "Checksum.h"
+#include "EepromPackWriter.h"
+#include "Enums.h"
+#include "TimeZoneDate.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        struct Weighted
+        {
+            unsigned int value;
+            unsigned int weight;
+        };
+
+        struct Region
+        {
+            unsigned int regionFlags;
+            unsigned int videoStandardFlags;
+            unsigned int dvdZone;
+            unsigned int weight;
+        };
+
+        const Region REGIONS[] =
+        {
+            { 0x00000001, 0x00400100, 1, 55 },  // North America, NTSC-M
+            { 0x00000004, 0x00800300, 2, 35 },  // Europe, PAL-I
+            { 0x00000002, 0x00400200, 2, 10 }   // Japan, NTSC-J
+        };
+
+        const Weighted LANGUAGES[] =
+        {
+            { LANGUAGE_ENGLISH, 60 },
+            { LANGUAGE_GERMAN, 9 },
+            { LANGUAGE_FRENCH, 9 },
+            { LANGUAGE_SPANISH, 7 },
+            { LANGUAGE_ITALIAN, 5 },
+            { LANGUAGE_JAPANESE, 6 },
+            { LANGUAGE_PORTUGUESE, 2 },
+            { LANGUAGE_KOREAN, 1 },
+            { LANGUAGE_CHINESE, 1 }
+        };
+
+        const Weighted ASPECT_RATIOS[] =
+        {
+            { AspectRatio::NORMAL, 60 },
+            { AspectRatio::WIDESCREEN, 35 },
+            { AspectRatio::LETTERBOX, 5 }
+        };
+
+        const Weighted SPEAKER_MODES[] =
+        {
+            { AudioMode::STEREO, 60 },
+            { AudioMode::SURROUND, 32 },
+            { AudioMode::MONO, 8 }
+        };
+
+        // Time zone bias in minutes paired with whether DST applies
+        const Weighted TIME_ZONE_BIASES[] =
+        {
+            { 300, 20 },                    // Eastern
+            { 360, 10 },                    // Central
+            { 480, 12 },                    // Pacific
+            { 0, 15 },                      // GMT
+            { (unsigned int)-60, 25 },      // Central Europe
+            { (unsigned int)-540, 10 },     // Japan
+            { (unsigned int)-600, 8 }       // Eastern Australia
+        };
+
+        const unsigned long long SERIAL_SPACE = 1000000000000ULL;
+
+        // Images generated and encoded by a worker at a time
+        const unsigned int SLICE_SIZE = 4096;
+
+        // Pack records of one slice, ready to append in order
+        struct EncodedSlice
+        {
+            std::vector<unsigned char> bytes;
+            std::vector<unsigned int> sizes;
+            bool isReady;
+
+            EncodedSlice()
+                : isReady(false)
+            {
+            }
+        };
+
+        // splitmix64, a counter based generator so every image
+        // can be produced independently
+        class Random
+        {
+        public:
+            explicit Random(unsigned long long state)
+                : m_state(state)
+            {
+            }
+
+            unsigned long long Next()
+            {
+                unsigned long long z = (m_state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            bool Chance(unsigned int percent)
+            {
+                return (Next() % 100) < percent;
+            }
+
+            void Fill(unsigned char* bytes, unsigned int size)
+            {
+                for(unsigned int i = 0; i < size; ++i)
+                {
+                    bytes[i] = (unsigned char)Next();
+                }
+            }
+
+            template <typename T, unsigned int N>
+            const T& Pick(const T (&table)[N])
+            {
+                unsigned int total = 0;
+                for(unsigned int i = 0; i < N; ++i)
+                {
+                    total += table[i].weight;
+                }
+
+                unsigned int roll = (unsigned int)(Next() % total);
+                for(unsigned int i = 0; i < N - 1; ++i)
+                {
+                    if(roll < table[i].weight)
+                    {
+                        return table[i];
+                    }
+                    roll -= table[i].weight;
+                }
+                return table[N - 1];
+            }
+
+        private:
+            unsigned long long m_state;
+        };
+    }
+
+    CorpusGenerator::CorpusGenerator(unsigned long long seed)
+        : m_seed(seed)
+    {
+
+    }
+
+    void CorpusGenerator::Generate(unsigned long long index, EepromData& outImage) const
+    {
+        Random random(m_seed ^ (index * 0xD1B54A32D192ED03ULL));
+
+        memset(&outImage, 0, sizeof(outImage));
+
+        // Security section, encrypted on real units so any bytes do
+        const Region& region = random.Pick(REGIONS);
+        random.Fill(outImage.hmacSha1Hash, sizeof(outImage.hmacSha1Hash));
+        random.Fill(outImage.confounder, sizeof(outImage.confounder));
+        random.Fill(outImage.hddKey, sizeof(outImage.hddKey));
+        outImage.regionFlags = region.regionFlags;
+
+        // Factory section. Multiplying by a constant coprime to the
+        // size of the space is a bijection, so serials and MACs stay
+        // unique while not looking sequential.
+        unsigned long long serial = ((index % SERIAL_SPACE) * 7919ULL + (m_seed % SERIAL_SPACE)) % SERIAL_SPACE;
+        for(int digit = (int)sizeof(outImage.serial) - 1; digit >= 0; --digit)
+        {
+            outImage.serial[digit] = (char)('0' + serial % 10);
+            serial /= 10;
+        }
+
+        unsigned int macSuffix = (unsigned int)((index * 0x9E3779B1ULL + m_seed) & 0xFFFFFF);
+        outImage.macAddress[0] = 0x00;      // Microsoft OUI
+        outImage.macAddress[1] = 0x50;
+        outImage.macAddress[2] = 0xF2;
+        outImage.macAddress[3] = (unsigned char)(macSuffix >> 16);
+        outImage.macAddress[4] = (unsigned char)(macSuffix >> 8);
+        outImage.macAddress[5] = (unsigned char)macSuffix;
+
+        random.Fill(outImage.onlineKey, sizeof(outImage.onlineKey));
+        outImage.videoStandardFlags = region.videoStandardFlags;
+
+        // User section
+        const Weighted& bias = random.Pick(TIME_ZONE_BIASES);
+        outImage.timeZoneBias = bias.value;
+        if((int)bias.value > 0)
+        {
+            TimeZoneDate standard = { 11, 1, 0, 2 };
+            TimeZoneDate daylight = { 3, 2, 0, 2 };
+            outImage.timeZoneStandardStarts = standard.ToRaw();
+            outImage.timeZoneDaylightStarts = daylight.ToRaw();
+            outImage.timeZoneDaylightBias = (unsigned int)-60;
+            memcpy(outImage.timeZoneStandardName, "STD", 3);
+            memcpy(outImage.timeZoneDaylightName, "DST", 3);
+        }
+        else
+        {
+            memcpy(outImage.timeZoneStandardName, "STD", 3);
+            memcpy(outImage.timeZoneDaylightName, "STD", 3);
+        }
+
+        outImage.language = random.Pick(LANGUAGES).value;
+
+        unsigned int video = random.Pick(ASPECT_RATIOS).value;
+        if(random.Chance(70))
+        {
+            video |= SupportedResolution::RESOLUTION_480p;
+        }
+        if(random.Chance(35))
+        {
+            video |= SupportedResolution::RESOLUTION_720p;
+        }
+        if(random.Chance(20))
+        {
+            video |= SupportedResolution::RESOLUTION_1080i;
+        }
+        outImage.videoSettings = video;
+
+        unsigned int audio = random.Pick(SPEAKER_MODES).value;
+        if(audio == AudioMode::SURROUND && random.Chance(60))
+        {
+            audio |= AudioMode::AC3;
+        }
+        if(random.Chance(25))
+        {
+            audio |= AudioMode::DTS;
+        }
+        outImage.audioSettings = audio;
+
+        outImage.dvdZone = region.dvdZone;
+
+        Checksum::UpdateFactory(outImage);
+        Checksum::UpdateUser(outImage);
+    }
+
+    void CorpusGenerator::Generate(unsigned long long firstIndex, unsigned int count, EepromData* outImages) const
+    {
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            Generate(firstIndex + i, outImages[i]);
+        }
+    }
+
+    bool CorpusGenerator::WritePack(const char* path, unsigned int count, unsigned int threadCount) const
+    {
+        if(threadCount == 0)
+        {
+            threadCount = std::thread::hardware_concurrency();
+            if(threadCount == 0)
+            {
+                threadCount = 1;
+            }
+        }
+
+        // The first images are a fair sample to pick the base from
+        unsigned int sampleCount = (count < SLICE_SIZE) ? count : SLICE_SIZE;
+        std::vector<EepromData> sample(sampleCount);
+        Generate(0, sampleCount, sample.data());
+
+        EepromData base;
+        EepromPackWriter::ComputeBase(sample.data(), sampleCount, base);
+
+        EepromPackWriter writer;
+        if(!writer.Open(path, base))
+        {
+            return false;
+        }
+
+        unsigned int sliceCount = (unsigned int)(((unsigned long long)count + SLICE_SIZE - 1) / SLICE_SIZE);
+        if(threadCount > sliceCount)
+        {
+            threadCount = sliceCount;
+        }
+
+        // Workers generate and encode slices in turn while this
+        // thread only appends finished slices in order. A slice is
+        // started once it is within a window of the next one to be
+        // written, which bounds the memory in flight.
+        const unsigned int windowSize = threadCount * 2;
+        std::vector<EncodedSlice> window(windowSize);
+        std::mutex mutex;
+        std::condition_variable changed;
+        unsigned int nextToWrite = 0;
+        bool stop = false;
+
+        std::vector<std::thread> workers;
+        for(unsigned int worker = 0; worker < threadCount; ++worker)
+        {
+            workers.push_back(std::thread(
+                [&, worker]()
+                {
+                    std::vector<EepromData> images(SLICE_SIZE);
+
+                    for(unsigned int slice = worker; slice < sliceCount; slice += threadCount)
+                    {
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            changed.wait(lock, [&]() { return stop || slice < nextToWrite + windowSize; });
+                            if(stop)
+                            {
+                                return;
+                            }
+                        }
+
+                        unsigned int first = slice * SLICE_SIZE;
+                        unsigned int imageCount = (count - first < SLICE_SIZE) ? count - first : SLICE_SIZE;
+                        Generate(first, imageCount, images.data());
+
+                        // The slot is only touched by this worker until
+                        // it is marked ready
+                        EncodedSlice& encoded = window[slice % windowSize];
+                        encoded.bytes.clear();
+                        encoded.sizes.clear();
+                        for(unsigned int i = 0; i < imageCount; ++i)
+                        {
+                            size_t start = encoded.bytes.size();
+                            EepromPackWriter::EncodeRecord(base, images[i], encoded.bytes);
+                            encoded.sizes.push_back((unsigned int)(encoded.bytes.size() - start));
+                        }
+
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            encoded.isReady = true;
+                        }
+                        changed.notify_all();
+                    }
+                }));
+        }
+
+        bool success = true;
+        for(unsigned int slice = 0; slice < sliceCount && success; ++slice)
+        {
+            EncodedSlice& encoded = window[slice % windowSize];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return encoded.isReady; });
+            }
+
+            const unsigned char* record = encoded.bytes.data();
+            for(unsigned int i = 0; i < encoded.sizes.size() && success; ++i)
+            {
+                success = writer.AppendEncoded(record, encoded.sizes[i]);
+                record += encoded.sizes[i];
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                encoded.isReady = false;
+                nextToWrite++;
+                stop = !success;
+            }
+            changed.notify_all();
+        }
+
+        for(unsigned int i = 0; i < workers.size(); ++i)
+        {
+            workers[i].join();
+        }
+
+        return writer.Close() && success;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,80 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef CORPUS_GENERATOR_H
+#define CORPUS_GENERATOR_H
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Generates synthetic eeprom images for load testing.
+     * 
+     * Images have valid factory and user checksums, unique serial
+     * numbers and MAC addresses, and settings drawn from weighted
+     * distributions. Each image depends only on the seed and its
+     * index, so any range of a corpus can be generated on its own
+     * and the output does not depend on the number of threads.
+     * 
+     */
+    class CorpusGenerator
+    {
+    public:
+        /**
+         * @brief Construct a generator.
+         * 
+         * @param seed Seed of the corpus. The same seed always
+         * produces the same images.
+         */
+        explicit CorpusGenerator(unsigned long long seed);
+
+        /**
+         * @brief Generate a single image.
+         * 
+         * @param index Index of the image in the corpus. Serial
+         * numbers are unique below 10^12, MAC addresses below 2^24.
+         * @param outImage Overwritten with the generated image.
+         */
+        void Generate(unsigned long long index, EepromData& outImage) const;
+
+        /**
+         * @brief Generate a range of images.
+         * 
+         * @param firstIndex Index of the first image.
+         * @param count Number of images to generate.
+         * @param outImages Receives count images.
+         */
+        void Generate(unsigned long long firstIndex, unsigned int count, EepromData* outImages) const;
+
+        /**
+         * @brief Generate a corpus straight into a pack file.
+         * Workers generate and delta encode slices of the corpus
+         * while the calling thread only appends the encoded
+         * records, so the pack is the same for any thread count.
+         * 
+         * @param path Path of the pack file to create.
+         * @param count Number of images to generate.
+         * @param threadCount Number of worker threads, 0 to use
+         * one per hardware thread.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool WritePack(const char* path, unsigned int count, unsigned int threadCount = 0) const;
+
+    private:
+        unsigned long long m_seed;
+    };
+} // namespace EEasyXB
+
+#endif // CORPUS_GENERATOR_H
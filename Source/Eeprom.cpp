@@ -15,25 +15,18 @@ Copyright 2021 Chase Cobb
 // https://github.com/Ernegien/nxdk/commit/62bc74fa95a79724ff07688e70d44f5be0afeb3a
 
 #include "Eeprom.h"
+#include "Checksum.h"
+#include "History.h"
+#include "ParentalControl.h"
+#include "SettingsPublisher.h"
+#include <stddef.h>
+#include <string.h>
 #include <xboxkrnl/xboxkrnl.h>
 
 namespace EEasyXB
 {
-    //static member declaration
-    Eeprom* Eeprom::m_instance;
-
-    Eeprom::Eeprom()
-    {
-
-    }
-
-    Eeprom::~Eeprom()
-    {
-        if(m_instance)
-        {
-            delete m_instance;
-        }
-    }
+    //static member declaration, constant initialized
+    Eeprom Eeprom::m_instance;
 
     bool Eeprom::IsResolutionEnabled(SupportedResolution resolution)
     {
@@ -112,14 +105,16 @@ namespace EEasyXB
     {
         if(DataIsReady())
         {
+            unsigned int videoSettings = m_data.videoSettings;
             if(isEnabled)
             {
-                m_data.videoSettings |= (int)resolution;
+                videoSettings |= (int)resolution;
             }
             else
             {
-                m_data.videoSettings &= ~((int)resolution);
+                videoSettings &= ~((int)resolution);
             }
+            SetUserField(&(m_data.videoSettings), videoSettings);
         }
     }
 
@@ -127,11 +122,12 @@ namespace EEasyXB
     {
         if(DataIsReady())
         {
-            m_data.videoSettings &= ~(AspectRatio::WIDESCREEN | AspectRatio::LETTERBOX);
+            unsigned int videoSettings = m_data.videoSettings & ~(AspectRatio::WIDESCREEN | AspectRatio::LETTERBOX);
             if(aspectRatio != AspectRatio::NORMAL)
             {
-                m_data.videoSettings |= (int)aspectRatio;
+                videoSettings |= (int)aspectRatio;
             }
+            SetUserField(&(m_data.videoSettings), videoSettings);
         }
     }
 
@@ -139,41 +135,42 @@ namespace EEasyXB
     {
         if(DataIsReady())
         {
+            unsigned int audioSettings = m_data.audioSettings;
             if(isEnabled)
             {
                 switch (audioMode)
                 {
                     case AudioMode::MONO:
                     {
-                        m_data.audioSettings &= ~(AudioMode::SURROUND | 
-                                                  AudioMode::AC3);
-                        m_data.audioSettings |= AudioMode::MONO;
+                        audioSettings &= ~(AudioMode::SURROUND | 
+                                           AudioMode::AC3);
+                        audioSettings |= AudioMode::MONO;
                         break;
                     }
                     case AudioMode::STEREO:
                     {
-                        m_data.audioSettings &= ~(AudioMode::MONO |
-                                                  AudioMode::SURROUND | 
-                                                  AudioMode::AC3);
+                        audioSettings &= ~(AudioMode::MONO |
+                                           AudioMode::SURROUND | 
+                                           AudioMode::AC3);
                         break;
                     }
                     case AudioMode::SURROUND:
                     {
-                        m_data.audioSettings &= ~(AudioMode::MONO);
-                        m_data.audioSettings |= AudioMode::SURROUND;
+                        audioSettings &= ~(AudioMode::MONO);
+                        audioSettings |= AudioMode::SURROUND;
                         break;
                     }
                     case AudioMode::AC3:
                     {
                         if(IsAudioModeEnabled(AudioMode::SURROUND))
                         {
-                            m_data.audioSettings |= AudioMode::AC3;
+                            audioSettings |= AudioMode::AC3;
                         }
                         break;
                     }
                     case AudioMode::DTS:
                     {
-                        m_data.audioSettings |= AudioMode::DTS;
+                        audioSettings |= AudioMode::DTS;
                         break;
                     }
                 }
@@ -184,27 +181,219 @@ namespace EEasyXB
                 {
                     case AudioMode::AC3:
                     {
-                        m_data.audioSettings &= ~AudioMode::AC3;
+                        audioSettings &= ~AudioMode::AC3;
                         break;
                     }
                     case AudioMode::DTS:
                     {
-                        m_data.audioSettings &= ~AudioMode::DTS;
+                        audioSettings &= ~AudioMode::DTS;
                         break;
                     }
                 }
             }
+            SetUserField(&(m_data.audioSettings), audioSettings);
+        }
+    }
+
+    TimeZone Eeprom::GetTimeZone()
+    {
+        if(DataIsReady())
+        {
+            return TimeZone(m_data);
+        }
+
+        return TimeZone();
+    }
+
+    void Eeprom::SetTimeZoneBias(int bias)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.timeZoneBias), (unsigned int)bias);
+        }
+    }
+
+    void Eeprom::SetTimeZoneStandardBias(int bias)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.timeZoneStandardBias), (unsigned int)bias);
+        }
+    }
+
+    void Eeprom::SetTimeZoneDaylightBias(int bias)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.timeZoneDaylightBias), (unsigned int)bias);
+        }
+    }
+
+    void Eeprom::SetTimeZoneStandardStart(const TimeZoneDate& date)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.timeZoneStandardStarts), date.ToRaw());
+        }
+    }
+
+    void Eeprom::SetTimeZoneDaylightStart(const TimeZoneDate& date)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.timeZoneDaylightStarts), date.ToRaw());
+        }
+    }
+
+    unsigned int Eeprom::GetIpAddress()
+    {
+        return DataIsReady() ? m_data.liveIp : 0;
+    }
+
+    unsigned int Eeprom::GetDnsServer()
+    {
+        return DataIsReady() ? m_data.liveDns : 0;
+    }
+
+    unsigned int Eeprom::GetGateway()
+    {
+        return DataIsReady() ? m_data.liveGateway : 0;
+    }
+
+    unsigned int Eeprom::GetSubnetMask()
+    {
+        return DataIsReady() ? m_data.liveSubnet : 0;
+    }
+
+    void Eeprom::SetIpAddress(unsigned int address)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.liveIp), address);
+        }
+    }
+
+    void Eeprom::SetDnsServer(unsigned int address)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.liveDns), address);
+        }
+    }
+
+    void Eeprom::SetGateway(unsigned int address)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.liveGateway), address);
         }
     }
 
+    void Eeprom::SetSubnetMask(unsigned int mask)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.liveSubnet), mask);
+        }
+    }
+
+    GameRating Eeprom::GetGameRating()
+    {
+        return DataIsReady() ? (GameRating)m_data.parentalControlGame : GameRating::GAME_RATING_ALL;
+    }
+
+    MovieRating Eeprom::GetMovieRating()
+    {
+        return DataIsReady() ? (MovieRating)m_data.parentalControlMovie : MovieRating::MOVIE_RATING_ALL;
+    }
+
+    bool Eeprom::GetPasscode(PasscodeButton* outButtons)
+    {
+        unsigned int rawPasscode = DataIsReady() ? m_data.parentalControlPasscode : 0;
+        return ParentalControl::DecodePasscode(rawPasscode, outButtons);
+    }
+
+    void Eeprom::SetGameRating(GameRating rating)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.parentalControlGame), (unsigned int)rating);
+        }
+    }
+
+    void Eeprom::SetMovieRating(MovieRating rating)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.parentalControlMovie), (unsigned int)rating);
+        }
+    }
+
+    void Eeprom::SetPasscode(const PasscodeButton* buttons)
+    {
+        if(DataIsReady())
+        {
+            SetUserField(&(m_data.parentalControlPasscode), ParentalControl::EncodePasscode(buttons));
+        }
+    }
+
+    unsigned int Eeprom::GetHistoryCount()
+    {
+        return DataIsReady() ? History::GetCount(m_data) : 0;
+    }
+
+    bool Eeprom::GetHistoryEntry(unsigned int index, HistoryEntry& outEntry)
+    {
+        return DataIsReady() && History::Get(m_data, index, outEntry);
+    }
+
+    bool Eeprom::FormatHistory()
+    {
+        if(!DataIsReady())
+        {
+            return false;
+        }
+
+        // Outside both checksummed sections, nothing to update
+        History::Format(m_data);
+        return true;
+    }
+
+    bool Eeprom::AppendHistoryEntry(const HistoryEntry& entry)
+    {
+        return DataIsReady() && History::Append(m_data, entry);
+    }
+
+    void Eeprom::SetPublishTarget(PublishedSettings* block)
+    {
+        m_publishTarget = block;
+    }
+
     Eeprom* Eeprom::GetInstance()
     {
-        if (!m_instance)
+        return &m_instance;
+    }
+
+    bool Eeprom::Init(bool warmStart)
+    {
+        m_dataIsInitialized = false;
+
+        if(warmStart)
         {
-            m_instance = new Eeprom();
+            return Read();
         }
 
-        return m_instance;
+        return true;
+    }
+
+    void Eeprom::Shutdown()
+    {
+        memset(&m_data, 0, sizeof(m_data));
+        m_userSum = 0;
+        m_dataIsInitialized = false;
+        m_factoryChecksumValid = false;
+        m_userChecksumValid = false;
+        m_publishTarget = NULL;
     }
 
     bool Eeprom::Read()
@@ -213,39 +402,65 @@ namespace EEasyXB
         unsigned long bytesRead;
 
         m_dataIsInitialized = false;
+        m_factoryChecksumValid = false;
+        m_userChecksumValid = false;
 
         if(ExQueryNonVolatileSetting(0xFFFF, &type, &m_data, sizeof(EepromData), &bytesRead) == STATUS_SUCCESS)
         {
+            // The image is kept as read. Only the running user sum
+            // is seeded here, setters keep userChecksum in step with
+            // it, so Write() never has to sum the sections again.
+            m_userSum = Checksum::Sum((const unsigned char*)&(m_data.timeZoneBias), Checksum::USER_SECTION_LENGTH);
+            m_factoryChecksumValid = Checksum::IsFactoryValid(m_data);
+            m_userChecksumValid = (m_data.userChecksum == Checksum::FromSum(m_userSum));
             m_dataIsInitialized = true;
+
+            if(m_publishTarget)
+            {
+                SettingsPublisher::Publish(m_publishTarget, m_data);
+            }
         }
 
         return m_dataIsInitialized;
     }
 
-    bool Eeprom::Write()
+    bool Eeprom::IsFactoryChecksumValid()
     {
-        // update checksums
-        CalculateChecksum(&(m_data.factoryChecksum), (unsigned char*)&(m_data.serial), 0x2C);
-        CalculateChecksum(&(m_data.userChecksum), (unsigned char*)&(m_data.timeZoneBias), 0x5C);
-
-        return (ExSaveNonVolatileSetting(0xFFFF, 0, &m_data, sizeof(EepromData)) == STATUS_SUCCESS);
+        return DataIsReady() && m_factoryChecksumValid;
     }
 
-    void Eeprom::CalculateChecksum(unsigned int* outSum, unsigned char* data, unsigned int length)
+    bool Eeprom::IsUserChecksumValid()
     {
-        unsigned int high = 0, low = 0;
+        return DataIsReady() && m_userChecksumValid;
+    }
 
-        for (unsigned int i = 0; i < length / sizeof(unsigned int); i++)
+    bool Eeprom::Write()
+    {
+        // Never save data that was not read from the eeprom, it
+        // would overwrite the security section and checksums.
+        if(!m_dataIsInitialized)
         {
-            unsigned int val = ((unsigned int*)data)[i];
-            unsigned long long sum = ((unsigned long long)high << 32) | low;
+            return false;
+        }
 
-            high = (unsigned int)((sum + val) >> 32);
-            low += val;
+        bool success = (ExSaveNonVolatileSetting(0xFFFF, 0, &m_data, sizeof(EepromData)) == STATUS_SUCCESS);
+
+        if(success && m_publishTarget)
+        {
+            SettingsPublisher::Publish(m_publishTarget, m_data);
         }
 
-        *outSum = ~(high + low);
-    } 
+        return success;
+    }
+
+    void Eeprom::SetUserField(unsigned int* field, unsigned int value)
+    {
+        // The checksum is derived from the 64 bit sum of the user
+        // section, so swapping one word only needs that sum adjusted.
+        m_userSum = m_userSum - *field + value;
+        *field = value;
+        m_data.userChecksum = Checksum::FromSum(m_userSum);
+    }
 
     bool Eeprom::DataIsReady()
     {
@@ -17,11 +17,19 @@ Copyright 2021 Chase Cobb
 #ifndef EEPROM_H
 #define EEPROM_H
 
+#include <stddef.h>
+
 #include "EepromData.h"
 #include "Enums.h"
+#include "HistoryEntry.h"
+#include "IpAddress.h"
+#include "TimeZone.h"
+#include "TimeZoneDate.h"
 
 namespace EEasyXB
 {
+    struct PublishedSettings;
+
     /**
      * @brief Wrapper class that provides functionality for
      * reading eeprom data from the original Xbox, modifying
@@ -103,6 +111,137 @@ namespace EEasyXB
          */
         void SetAudioModeEnabled(AudioMode audioMode, bool isEnabled);
 
+        /**
+         * @brief Get a decoder for the time zone settings
+         * currently stored in the eeprom.
+         * 
+         * @return TimeZone Converter between local time and
+         * UTC for the current settings.
+         */
+        TimeZone GetTimeZone();
+
+        /**
+         * @brief Set the base time zone bias.
+         * 
+         * @param bias Minutes to add to local time to get UTC.
+         */
+        void SetTimeZoneBias(int bias);
+
+        /**
+         * @brief Set the bias applied on top of the base bias
+         * while standard time is in effect.
+         * 
+         * @param bias Bias in minutes.
+         */
+        void SetTimeZoneStandardBias(int bias);
+
+        /**
+         * @brief Set the bias applied on top of the base bias
+         * while daylight saving time is in effect.
+         * 
+         * @param bias Bias in minutes.
+         */
+        void SetTimeZoneDaylightBias(int bias);
+
+        /**
+         * @brief Set the rule that starts standard time.
+         * 
+         * @param date Transition rule. A month of 0 disables
+         * daylight saving time.
+         */
+        void SetTimeZoneStandardStart(const TimeZoneDate& date);
+
+        /**
+         * @brief Set the rule that starts daylight saving time.
+         * 
+         * @param date Transition rule. A month of 0 disables
+         * daylight saving time.
+         */
+        void SetTimeZoneDaylightStart(const TimeZoneDate& date);
+
+        /**
+         * @brief Get the static IP address of the Xbox.
+         * 
+         * @return unsigned int Address encoded as described by
+         * EEasyXB::IpAddress. 0 if the address is assigned by DHCP.
+         */
+        unsigned int GetIpAddress();
+
+        /**
+         * @brief Get the DNS server address.
+         * 
+         * @return unsigned int Address encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        unsigned int GetDnsServer();
+
+        /**
+         * @brief Get the default gateway address.
+         * 
+         * @return unsigned int Address encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        unsigned int GetGateway();
+
+        /**
+         * @brief Get the subnet mask.
+         * 
+         * @return unsigned int Mask encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        unsigned int GetSubnetMask();
+
+        /**
+         * @brief Set the static IP address of the Xbox.
+         * 
+         * @param address Address encoded as described by
+         * EEasyXB::IpAddress. 0 to use DHCP.
+         */
+        void SetIpAddress(unsigned int address);
+
+        /**
+         * @brief Set the DNS server address.
+         * 
+         * @param address Address encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        void SetDnsServer(unsigned int address);
+
+        /**
+         * @brief Set the default gateway address.
+         * 
+         * @param address Address encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        void SetGateway(unsigned int address);
+
+        /**
+         * @brief Set the subnet mask.
+         * 
+         * @param mask Mask encoded as described by
+         * EEasyXB::IpAddress.
+         */
+        void SetSubnetMask(unsigned int mask);
+
+        /**
+         * @brief Prepare the eeprom for use. Optional, data is
+         * otherwise read on first access.
+         * 
+         * @param warmStart If true the eeprom is read now, moving
+         * the cost of the first read out of the first access.
+         * @return true If the eeprom is ready, or warmStart was false.
+         * @return false If warmStart was true and the read failed.
+         */
+        bool Init(bool warmStart = false);
+
+        /**
+         * @brief Discard the local eeprom data and stop publishing.
+         * Unsaved modifications are lost, and the next access reads
+         * the eeprom again.
+         * 
+         */
+        void Shutdown();
+
         /**
          * @brief Reads the eeprom of the Xbox and stores it
          * to the local eeprom data.
@@ -112,37 +251,178 @@ namespace EEasyXB
          */
         bool Read();
 
+        /**
+         * @brief Checks to see if the factory checksum of the
+         * eeprom was valid when it was last read. Read() does not
+         * repair checksums, so a corrupt image is written back as
+         * it was read.
+         * 
+         * @return true If the factory checksum was valid.
+         * @return false If it was invalid or the read failed.
+         */
+        bool IsFactoryChecksumValid();
+
+        /**
+         * @brief Checks to see if the user checksum of the eeprom
+         * was valid when it was last read. Setters store a user
+         * checksum that matches the data they produce, so a write
+         * after a change stores a valid user checksum either way.
+         * 
+         * @return true If the user checksum was valid.
+         * @return false If it was invalid or the read failed.
+         */
+        bool IsUserChecksumValid();
+
         /**
          * @brief Writes the current modifications of the
          * eeprom data to the eeprom of the Xbox.
          * 
          * @return true If the operation was successful.
-         * @return false Otherwise.
+         * @return false Otherwise, including when the eeprom has
+         * not been read since Init() or Shutdown().
          */
         bool Write();
 
         /**
-         * @brief Get the Instance of the Eeprom object.
+         * @brief Get the most mature game rating allowed by
+         * parental controls.
+         * 
+         * @return GameRating Enumeration of game ratings.
+         * Indexed by EEasyXB::GameRating.
+         */
+        GameRating GetGameRating();
+
+        /**
+         * @brief Get the most mature movie rating allowed by
+         * parental controls.
+         * 
+         * @return MovieRating Enumeration of movie ratings.
+         * Indexed by EEasyXB::MovieRating.
+         */
+        MovieRating GetMovieRating();
+
+        /**
+         * @brief Get the parental control passcode.
+         * 
+         * @param outButtons Receives ParentalControl::PASSCODE_LENGTH
+         * buttons, in the order they are entered.
+         * @return true If a passcode is set.
+         * @return false Otherwise.
+         */
+        bool GetPasscode(PasscodeButton* outButtons);
+
+        /**
+         * @brief Set the most mature game rating allowed by
+         * parental controls.
+         * 
+         * @param rating Enumeration of game ratings.
+         * Indexed by EEasyXB::GameRating.
+         */
+        void SetGameRating(GameRating rating);
+
+        /**
+         * @brief Set the most mature movie rating allowed by
+         * parental controls.
+         * 
+         * @param rating Enumeration of movie ratings.
+         * Indexed by EEasyXB::MovieRating.
+         */
+        void SetMovieRating(MovieRating rating);
+
+        /**
+         * @brief Set the parental control passcode.
+         * 
+         * @param buttons ParentalControl::PASSCODE_LENGTH buttons in
+         * the order they are entered, or NULL to clear the passcode.
+         */
+        void SetPasscode(const PasscodeButton* buttons);
+
+        /**
+         * @brief Get the number of entries in the history section.
+         * 
+         * @return unsigned int Number of entries, up to
+         * History::CAPACITY.
+         */
+        unsigned int GetHistoryCount();
+
+        /**
+         * @brief Get one entry of the history section.
+         * 
+         * @param index 0 for the oldest entry.
+         * @param outEntry Receives the entry.
+         * @return true If the entry exists.
+         * @return false Otherwise.
+         */
+        bool GetHistoryEntry(unsigned int index, HistoryEntry& outEntry);
+
+        /**
+         * @brief Clear the history section and start an empty
+         * history in it. Whatever the section held before is lost
+         * once the eeprom is written.
+         * 
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool FormatHistory();
+
+        /**
+         * @brief Append an entry to the history section,
+         * overwriting the oldest entry once it is full.
+         * 
+         * @param entry Entry to append.
+         * @return true If the entry was appended.
+         * @return false If the eeprom could not be read or the
+         * section has not been formatted with FormatHistory().
+         */
+        bool AppendHistoryEntry(const HistoryEntry& entry);
+
+        /**
+         * @brief Publish the eeprom data to a shared block after
+         * every successful Read() and Write(), so other readers can
+         * use it through EEasyXB::SettingsPublisher without going
+         * back to the eeprom.
+         * 
+         * @param block Block prepared with SettingsPublisher::Initialize(),
+         * or NULL to stop publishing.
+         */
+        void SetPublishTarget(PublishedSettings* block);
+
+        /**
+         * @brief Get the Instance of the Eeprom object. The
+         * instance is statically allocated and constant
+         * initialized, so this never allocates.
          * 
          * @return Eeprom* Local object used to perform
          * modifications of the Xbox eeprom.
          */
         static Eeprom* GetInstance();
     private:
-        static Eeprom* m_instance;
+        static Eeprom m_instance;
         EepromData m_data;
+        unsigned long long m_userSum;   // running sum behind userChecksum
         bool m_dataIsInitialized;
+        bool m_factoryChecksumValid;    // as last read
+        bool m_userChecksumValid;
+        PublishedSettings* m_publishTarget;
 
         // Singleton - keep these private!!
-        Eeprom();
+        constexpr Eeprom()
+            : m_data(),
+              m_userSum(0),
+              m_dataIsInitialized(false),
+              m_factoryChecksumValid(false),
+              m_userChecksumValid(false),
+              m_publishTarget(NULL)
+        {
+        }
         Eeprom(const Eeprom& copy);
         Eeprom& operator=(const Eeprom& copy);
-        ~Eeprom();
+        ~Eeprom() = default;
 
         // TODO : Backup EEprom to HDD
 
         bool DataIsReady();
-        void CalculateChecksum(unsigned int* outSum, unsigned char* data, unsigned int length);
+        void SetUserField(unsigned int* field, unsigned int value);
     };
 } // namespace EEasyXB
 
@@ -0,0 +1,305 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "EepromPackReader.h"
+
+#include <string.h>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        const unsigned int NO_BLOCK = 0xFFFFFFFF;
+
+        unsigned long long BlockOffset(const EepromPackBlock& block)
+        {
+            return ((unsigned long long)block.offsetHigh << 32) | block.offsetLow;
+        }
+    }
+
+    EepromPackReader::EepromPackReader()
+        : m_file(NULL),
+          m_loadedBlock(NO_BLOCK),
+          m_cursor(0),
+          m_nextRecord(0)
+    {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    EepromPackReader::~EepromPackReader()
+    {
+        Close();
+    }
+
+    bool EepromPackReader::Open(const char* path)
+    {
+        Close();
+
+        m_file = fopen(path, "rb");
+        if(!m_file)
+        {
+            return false;
+        }
+
+        // Everything the header and index claim is checked against
+        // the file size, so a corrupt pack cannot size a buffer or
+        // point a block outside the file.
+        long fileSize = -1;
+        if(fseek(m_file, 0, SEEK_END) == 0)
+        {
+            fileSize = ftell(m_file);
+        }
+
+        bool success = fileSize >= 0 &&
+                       fseek(m_file, 0, SEEK_SET) == 0 &&
+                       fread(&m_header, sizeof(m_header), 1, m_file) == 1 &&
+                       m_header.magic == EepromPackHeader::MAGIC &&
+                       m_header.version == EepromPackHeader::VERSION &&
+                       m_header.recordsPerBlock != 0 &&
+                       m_header.blockCount == (unsigned int)(((unsigned long long)m_header.recordCount +
+                                                              m_header.recordsPerBlock - 1) /
+                                                             m_header.recordsPerBlock) &&
+                       fread(&m_base, sizeof(m_base), 1, m_file) == 1;
+
+        if(success)
+        {
+            unsigned long long dataStart = sizeof(m_header) + sizeof(m_base);
+            unsigned long long indexOffset = ((unsigned long long)m_header.indexOffsetHigh << 32) |
+                                             m_header.indexOffsetLow;
+
+            success = indexOffset >= dataStart &&
+                      indexOffset + (unsigned long long)m_header.blockCount * sizeof(EepromPackBlock) <=
+                          (unsigned long long)fileSize;
+
+            if(success)
+            {
+                m_blocks.resize(m_header.blockCount);
+
+                success = fseek(m_file, (long)indexOffset, SEEK_SET) == 0 &&
+                          fread(m_blocks.data(), sizeof(EepromPackBlock), m_blocks.size(), m_file) == m_blocks.size();
+            }
+
+            // Lets the last block find its end like every other block
+            EepromPackBlock end;
+            end.offsetLow = m_header.indexOffsetLow;
+            end.offsetHigh = m_header.indexOffsetHigh;
+            m_blocks.push_back(end);
+
+            // Blocks must run in order between the base image and
+            // the index
+            unsigned long long previous = dataStart;
+            for(unsigned int i = 0; success && i < m_blocks.size(); ++i)
+            {
+                unsigned long long offset = BlockOffset(m_blocks[i]);
+                success = offset >= previous && offset <= indexOffset;
+                previous = offset;
+            }
+        }
+
+        if(!success)
+        {
+            Close();
+        }
+
+        return success;
+    }
+
+    void EepromPackReader::Close()
+    {
+        if(m_file)
+        {
+            fclose(m_file);
+            m_file = NULL;
+        }
+
+        memset(&m_header, 0, sizeof(m_header));
+        m_blocks.clear();
+        m_blockBuffer.clear();
+        m_loadedBlock = NO_BLOCK;
+        m_cursor = 0;
+        m_nextRecord = 0;
+    }
+
+    unsigned int EepromPackReader::GetCount() const
+    {
+        return m_header.recordCount;
+    }
+
+    unsigned int EepromPackReader::GetPosition() const
+    {
+        return m_nextRecord;
+    }
+
+    const EepromData& EepromPackReader::GetBase() const
+    {
+        return m_base;
+    }
+
+    bool EepromPackReader::Next(EepromData& outImage)
+    {
+        if(!m_file || m_nextRecord >= m_header.recordCount)
+        {
+            return false;
+        }
+
+        unsigned int block = m_nextRecord / m_header.recordsPerBlock;
+        if(block != m_loadedBlock && !LoadBlock(block))
+        {
+            return false;
+        }
+
+        outImage = m_base;
+        if(!DecodeRecord((unsigned char*)&outImage))
+        {
+            return false;
+        }
+
+        m_nextRecord++;
+        return true;
+    }
+
+    bool EepromPackReader::Seek(unsigned int index)
+    {
+        if(!m_file || index > m_header.recordCount)
+        {
+            return false;
+        }
+
+        unsigned int block = index / m_header.recordsPerBlock;
+        unsigned int firstInBlock = block * m_header.recordsPerBlock;
+
+        // Continue from the current position when it is already
+        // in the right block and not past the target.
+        if(block != m_loadedBlock || m_nextRecord > index)
+        {
+            if(index == m_header.recordCount && index == firstInBlock)
+            {
+                m_nextRecord = index;
+                return true;
+            }
+
+            if(!LoadBlock(block))
+            {
+                return false;
+            }
+            m_nextRecord = firstInBlock;
+        }
+
+        EepromData skipped;
+        while(m_nextRecord < index)
+        {
+            skipped = m_base;
+            if(!DecodeRecord((unsigned char*)&skipped))
+            {
+                return false;
+            }
+            m_nextRecord++;
+        }
+
+        return true;
+    }
+
+    bool EepromPackReader::Read(unsigned int index, EepromData& outImage)
+    {
+        return Seek(index) && Next(outImage);
+    }
+
+    bool EepromPackReader::LoadBlock(unsigned int block)
+    {
+        if(block >= m_header.blockCount)
+        {
+            return false;
+        }
+
+        unsigned long long start = BlockOffset(m_blocks[block]);
+        unsigned long long end = BlockOffset(m_blocks[block + 1]);
+
+        m_loadedBlock = NO_BLOCK;
+        m_blockBuffer.resize((size_t)(end - start));
+
+        if(fseek(m_file, (long)start, SEEK_SET) != 0 ||
+           fread(m_blockBuffer.data(), 1, m_blockBuffer.size(), m_file) != m_blockBuffer.size())
+        {
+            return false;
+        }
+
+        m_loadedBlock = block;
+        m_cursor = 0;
+        m_nextRecord = block * m_header.recordsPerBlock;
+        return true;
+    }
+
+    bool EepromPackReader::DecodeRecord(unsigned char* outBytes)
+    {
+        unsigned int position = 0;
+
+        while(position < sizeof(EepromData))
+        {
+            unsigned int skip, literal;
+            if(!GetVarint(&skip) || !GetVarint(&literal))
+            {
+                return false;
+            }
+
+            // Checked before adding so corrupt counts cannot wrap
+            if(skip > sizeof(EepromData) - position)
+            {
+                return false;
+            }
+            position += skip;
+
+            if(literal > sizeof(EepromData) - position ||
+               literal > m_blockBuffer.size() - m_cursor)
+            {
+                return false;
+            }
+
+            // A record that ends like the base has a final run with
+            // no literals, which may sit at the very end of the block
+            const unsigned char* delta = m_blockBuffer.data() + m_cursor;
+            for(unsigned int i = 0; i < literal; ++i)
+            {
+                outBytes[position + i] ^= delta[i];
+            }
+
+            position += literal;
+            m_cursor += literal;
+        }
+
+        return true;
+    }
+
+    bool EepromPackReader::GetVarint(unsigned int* outValue)
+    {
+        unsigned int value = 0;
+
+        for(unsigned int shift = 0; shift < 32; shift += 7)
+        {
+            if(m_cursor >= m_blockBuffer.size())
+            {
+                return false;
+            }
+
+            unsigned char byte = m_blockBuffer[m_cursor++];
+            value |= (unsigned int)(byte & 0x7F) << shift;
+
+            if((byte & 0x80) == 0)
+            {
+                *outValue = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,124 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef EEPROM_PACK_READER_H
+#define EEPROM_PACK_READER_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "EepromData.h"
+#include "EepromPackHeader.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Reads eeprom images from a pack file written by
+     * EEasyXB::EepromPackWriter, either streaming from start to
+     * end or at random through the block index.
+     * 
+     */
+    class EepromPackReader
+    {
+    public:
+        EepromPackReader();
+        ~EepromPackReader();
+
+        /**
+         * @brief Open a pack file and load its block index.
+         * 
+         * @param path Path of the file to read.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Open(const char* path);
+
+        /**
+         * @brief Close the pack file.
+         * 
+         */
+        void Close();
+
+        /**
+         * @brief Get the number of images in the pack.
+         * 
+         * @return unsigned int Number of images.
+         */
+        unsigned int GetCount() const;
+
+        /**
+         * @brief Get the index of the image the next call to
+         * Next() decodes.
+         * 
+         * @return unsigned int Index of the next image.
+         */
+        unsigned int GetPosition() const;
+
+        /**
+         * @brief Get the base image the records are stored
+         * relative to.
+         * 
+         * @return const EepromData& Base image.
+         */
+        const EepromData& GetBase() const;
+
+        /**
+         * @brief Decode the next image in the pack.
+         * 
+         * @param outImage Overwritten with the decoded image.
+         * @return true If an image was decoded.
+         * @return false At the end of the pack or on error.
+         */
+        bool Next(EepromData& outImage);
+
+        /**
+         * @brief Position the reader so the next call to Next()
+         * decodes a given image.
+         * 
+         * @param index Index of the image.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Seek(unsigned int index);
+
+        /**
+         * @brief Decode a single image.
+         * 
+         * @param index Index of the image.
+         * @param outImage Overwritten with the decoded image.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Read(unsigned int index, EepromData& outImage);
+
+    private:
+        FILE* m_file;
+        EepromPackHeader m_header;
+        EepromData m_base;
+        std::vector<EepromPackBlock> m_blocks;
+        std::vector<unsigned char> m_blockBuffer;
+        unsigned int m_loadedBlock;
+        unsigned int m_cursor;          // position in m_blockBuffer
+        unsigned int m_nextRecord;
+
+        bool LoadBlock(unsigned int block);
+        bool DecodeRecord(unsigned char* outBytes);
+        bool GetVarint(unsigned int* outValue);
+
+        // Not copyable, owns the file
+        EepromPackReader(const EepromPackReader& copy);
+        EepromPackReader& operator=(const EepromPackReader& copy);
+    };
+} // namespace EEasyXB
+
+#endif // EEPROM_PACK_READER_H
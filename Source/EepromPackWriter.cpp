@@ -0,0 +1,264 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "EepromPackWriter.h"
+
+#include <string.h>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        const unsigned int FLUSH_THRESHOLD = 64 * 1024;
+
+        // Zero gaps this short are cheaper to store as literals
+        // than to end the run for.
+        const unsigned int MAX_LITERAL_GAP = 2;
+
+        void PutVarint(std::vector<unsigned char>& buffer, unsigned int value)
+        {
+            while(value >= 0x80)
+            {
+                buffer.push_back((unsigned char)(value | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back((unsigned char)value);
+        }
+    }
+
+    EepromPackWriter::EepromPackWriter()
+        : m_file(NULL),
+          m_offset(0)
+    {
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    EepromPackWriter::~EepromPackWriter()
+    {
+        if(m_file)
+        {
+            Close();
+        }
+    }
+
+    bool EepromPackWriter::Open(const char* path, const EepromData& base, unsigned int recordsPerBlock)
+    {
+        if(m_file || recordsPerBlock == 0)
+        {
+            return false;
+        }
+
+        m_file = fopen(path, "wb");
+        if(!m_file)
+        {
+            return false;
+        }
+
+        memset(&m_header, 0, sizeof(m_header));
+        m_header.magic = EepromPackHeader::MAGIC;
+        m_header.version = EepromPackHeader::VERSION;
+        m_header.recordsPerBlock = recordsPerBlock;
+        m_base = base;
+        m_blocks.clear();
+        m_buffer.clear();
+
+        // The header is rewritten with the final counts on Close()
+        if(fwrite(&m_header, sizeof(m_header), 1, m_file) != 1 ||
+           fwrite(&m_base, sizeof(m_base), 1, m_file) != 1)
+        {
+            fclose(m_file);
+            m_file = NULL;
+            return false;
+        }
+
+        m_offset = sizeof(m_header) + sizeof(m_base);
+        return true;
+    }
+
+    bool EepromPackWriter::Append(const EepromData& image)
+    {
+        if(!m_file)
+        {
+            return false;
+        }
+
+        StartRecord();
+        EncodeRecord(m_base, image, m_buffer);
+        m_header.recordCount++;
+
+        if(m_buffer.size() >= FLUSH_THRESHOLD)
+        {
+            return Flush();
+        }
+
+        return true;
+    }
+
+    bool EepromPackWriter::AppendEncoded(const unsigned char* record, unsigned int size)
+    {
+        if(!m_file)
+        {
+            return false;
+        }
+
+        StartRecord();
+        m_buffer.insert(m_buffer.end(), record, record + size);
+        m_header.recordCount++;
+
+        if(m_buffer.size() >= FLUSH_THRESHOLD)
+        {
+            return Flush();
+        }
+
+        return true;
+    }
+
+    void EepromPackWriter::EncodeRecord(const EepromData& base, const EepromData& image,
+                                        std::vector<unsigned char>& outRecord)
+    {
+        unsigned char delta[sizeof(EepromData)];
+        const unsigned char* bytes = (const unsigned char*)&image;
+        const unsigned char* baseBytes = (const unsigned char*)&base;
+        for(unsigned int i = 0; i < sizeof(EepromData); ++i)
+        {
+            delta[i] = bytes[i] ^ baseBytes[i];
+        }
+
+        unsigned int position = 0;
+        while(position < sizeof(EepromData))
+        {
+            unsigned int skip = 0;
+            while(position + skip < sizeof(EepromData) && delta[position + skip] == 0)
+            {
+                skip++;
+            }
+            position += skip;
+
+            unsigned int literal = 0;
+            while(position + literal < sizeof(EepromData))
+            {
+                if(delta[position + literal] != 0)
+                {
+                    literal++;
+                    continue;
+                }
+
+                unsigned int gap = 0;
+                while(position + literal + gap < sizeof(EepromData) &&
+                      delta[position + literal + gap] == 0 &&
+                      gap <= MAX_LITERAL_GAP)
+                {
+                    gap++;
+                }
+
+                if(gap > MAX_LITERAL_GAP || position + literal + gap == sizeof(EepromData))
+                {
+                    break;
+                }
+                literal += gap;
+            }
+
+            PutVarint(outRecord, skip);
+            PutVarint(outRecord, literal);
+            outRecord.insert(outRecord.end(), delta + position, delta + position + literal);
+            position += literal;
+        }
+    }
+
+    bool EepromPackWriter::Close()
+    {
+        if(!m_file)
+        {
+            return false;
+        }
+
+        bool success = Flush();
+
+        m_header.blockCount = (unsigned int)m_blocks.size();
+        m_header.indexOffsetLow = (unsigned int)m_offset;
+        m_header.indexOffsetHigh = (unsigned int)(m_offset >> 32);
+
+        if(success && !m_blocks.empty())
+        {
+            success = (fwrite(m_blocks.data(), sizeof(EepromPackBlock), m_blocks.size(), m_file) == m_blocks.size());
+        }
+
+        success = success &&
+                  fseek(m_file, 0, SEEK_SET) == 0 &&
+                  fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+
+        success = (fclose(m_file) == 0) && success;
+        m_file = NULL;
+
+        return success;
+    }
+
+    unsigned int EepromPackWriter::GetCount() const
+    {
+        return m_header.recordCount;
+    }
+
+    void EepromPackWriter::ComputeBase(const EepromData* images, unsigned int count, EepromData& outBase)
+    {
+        std::vector<unsigned int> histogram(sizeof(EepromData) * 256, 0);
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            const unsigned char* bytes = (const unsigned char*)&images[i];
+            for(unsigned int j = 0; j < sizeof(EepromData); ++j)
+            {
+                histogram[j * 256 + bytes[j]]++;
+            }
+        }
+
+        unsigned char* baseBytes = (unsigned char*)&outBase;
+        for(unsigned int j = 0; j < sizeof(EepromData); ++j)
+        {
+            unsigned int best = 0;
+            for(unsigned int value = 1; value < 256; ++value)
+            {
+                if(histogram[j * 256 + value] > histogram[j * 256 + best])
+                {
+                    best = value;
+                }
+            }
+            baseBytes[j] = (unsigned char)best;
+        }
+    }
+
+    bool EepromPackWriter::Flush()
+    {
+        if(m_buffer.empty())
+        {
+            return true;
+        }
+
+        bool success = (fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size());
+        m_offset += m_buffer.size();
+        m_buffer.clear();
+
+        return success;
+    }
+
+    void EepromPackWriter::StartRecord()
+    {
+        if(m_header.recordCount % m_header.recordsPerBlock == 0)
+        {
+            unsigned long long blockOffset = m_offset + m_buffer.size();
+            EepromPackBlock block;
+            block.offsetLow = (unsigned int)blockOffset;
+            block.offsetHigh = (unsigned int)(blockOffset >> 32);
+            m_blocks.push_back(block);
+        }
+    }
+} // namespace EEasyXB
@@ -0,0 +1,126 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef EEPROM_PACK_WRITER_H
+#define EEPROM_PACK_WRITER_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "EepromData.h"
+#include "EepromPackHeader.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Writes eeprom images to a pack file, storing each one
+     * as a delta against a shared base image. See
+     * EEasyXB::EepromPackHeader for the file layout.
+     * 
+     */
+    class EepromPackWriter
+    {
+    public:
+        EepromPackWriter();
+        ~EepromPackWriter();
+
+        /**
+         * @brief Create a pack file.
+         * 
+         * @param path Path of the file to create.
+         * @param base Image every record is stored relative to.
+         * The closer it is to the images, the smaller the pack.
+         * @param recordsPerBlock Records between random access
+         * points. Smaller values make random reads faster and the
+         * block index larger.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Open(const char* path, const EepromData& base, unsigned int recordsPerBlock = 256);
+
+        /**
+         * @brief Append an image to the pack.
+         * 
+         * @param image Image to append.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Append(const EepromData& image);
+
+        /**
+         * @brief Append a record already encoded by EncodeRecord()
+         * against the base image of this pack. Lets the encoding
+         * run on other threads while the writer only copies bytes.
+         * 
+         * @param record Encoded record.
+         * @param size Size of the record in bytes.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool AppendEncoded(const unsigned char* record, unsigned int size);
+
+        /**
+         * @brief Write the block index and header and close the
+         * file. The pack is unreadable until this succeeds.
+         * 
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Close();
+
+        /**
+         * @brief Get the number of images appended so far.
+         * 
+         * @return unsigned int Number of images.
+         */
+        unsigned int GetCount() const;
+
+        /**
+         * @brief Build a base image where each byte is the most
+         * common value of that byte across a sample of images.
+         * 
+         * @param images Sample of the images to be packed.
+         * @param count Number of images in the sample.
+         * @param outBase Receives the base image.
+         */
+        static void ComputeBase(const EepromData* images, unsigned int count, EepromData& outBase);
+
+        /**
+         * @brief Encode an image as a pack record. Safe to call
+         * from any thread.
+         * 
+         * @param base Base image of the pack the record is for.
+         * @param image Image to encode.
+         * @param outRecord The record is appended to this buffer.
+         */
+        static void EncodeRecord(const EepromData& base, const EepromData& image,
+                                 std::vector<unsigned char>& outRecord);
+
+    private:
+        FILE* m_file;
+        EepromPackHeader m_header;
+        EepromData m_base;
+        unsigned long long m_offset;
+        std::vector<EepromPackBlock> m_blocks;
+        std::vector<unsigned char> m_buffer;
+
+        bool Flush();
+        void StartRecord();
+
+        // Not copyable, owns the file
+        EepromPackWriter(const EepromPackWriter& copy);
+        EepromPackWriter& operator=(const EepromPackWriter& copy);
+    };
+} // namespace EEasyXB
+
+#endif // EEPROM_PACK_WRITER_H
@@ -0,0 +1,139 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "History.h"
+
+#include <string.h>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        // Header word: magic in the low 16 bits, then the next
+        // slot, then the entry count.
+        unsigned int* Words(EepromData& image)
+        {
+            return (unsigned int*)image.history;
+        }
+
+        const unsigned int* Words(const EepromData& image)
+        {
+            return (const unsigned int*)image.history;
+        }
+
+        unsigned int NextSlot(unsigned int header)
+        {
+            return (header >> 16) & 0xFF;
+        }
+
+        unsigned int EntryCount(unsigned int header)
+        {
+            return header >> 24;
+        }
+
+        unsigned int MakeHeader(unsigned int magic, unsigned int nextSlot, unsigned int count)
+        {
+            return magic | (nextSlot << 16) | (count << 24);
+        }
+    }
+
+    bool History::IsFormatted(const EepromData& image)
+    {
+        unsigned int header = Words(image)[0];
+
+        // Until the ring wraps, the next slot is the entry count
+        return ((header & 0xFFFF) == MAGIC &&
+                NextSlot(header) < CAPACITY &&
+                EntryCount(header) <= CAPACITY &&
+                (EntryCount(header) == CAPACITY || NextSlot(header) == EntryCount(header)));
+    }
+
+    void History::Format(EepromData& image)
+    {
+        memset(image.history, 0, sizeof(image.history));
+        Words(image)[0] = MakeHeader(MAGIC, 0, 0);
+    }
+
+    unsigned int History::GetCount(const EepromData& image)
+    {
+        return IsFormatted(image) ? EntryCount(Words(image)[0]) : 0;
+    }
+
+    bool History::Get(const EepromData& image, unsigned int index, HistoryEntry& outEntry)
+    {
+        unsigned int count = GetCount(image);
+        if(index >= count)
+        {
+            return false;
+        }
+
+        // The oldest entry sits at the next slot once the ring has
+        // wrapped, and at slot 0 before that.
+        unsigned int header = Words(image)[0];
+        unsigned int oldest = (count == CAPACITY) ? NextSlot(header) : 0;
+        unsigned int slot = (oldest + index) % CAPACITY;
+
+        outEntry = HistoryEntry::FromRaw(Words(image)[1 + slot]);
+        return true;
+    }
+
+    bool History::Append(EepromData& image, const HistoryEntry& entry)
+    {
+        if(!IsFormatted(image))
+        {
+            return false;
+        }
+
+        unsigned int* words = Words(image);
+        unsigned int header = words[0];
+        unsigned int slot = NextSlot(header);
+        unsigned int count = EntryCount(header);
+
+        words[1 + slot] = entry.ToRaw();
+        words[0] = MakeHeader(MAGIC, (slot + 1) % CAPACITY, (count < CAPACITY) ? count + 1 : CAPACITY);
+        return true;
+    }
+
+    unsigned long long History::Visit(const EepromData* images, unsigned int count,
+                                      HistoryVisitor visitor, void* context)
+    {
+        unsigned long long visited = 0;
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            visited += Visit(images[i], i, visitor, context);
+        }
+
+        return visited;
+    }
+
+    unsigned int History::Visit(const EepromData& image, unsigned int imageIndex,
+                                HistoryVisitor visitor, void* context)
+    {
+        unsigned int count = GetCount(image);
+        if(count == 0)
+        {
+            return 0;
+        }
+
+        const unsigned int* words = Words(image);
+        unsigned int oldest = (count == CAPACITY) ? NextSlot(words[0]) : 0;
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            visitor(imageIndex, HistoryEntry::FromRaw(words[1 + (oldest + i) % CAPACITY]), context);
+        }
+
+        return count;
+    }
+} // namespace EEasyXB
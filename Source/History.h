@@ -0,0 +1,134 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "EepromData.h"
+#include "HistoryEntry.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Callback for History::Visit(), called once per entry
+     * from oldest to newest.
+     * 
+     * @param imageIndex Index of the image the entry belongs to.
+     * @param entry Decoded entry.
+     * @param context Pointer passed to History::Visit().
+     */
+    typedef void (*HistoryVisitor)(unsigned int imageIndex, const HistoryEntry& entry, void* context);
+
+    /**
+     * @brief Ring buffer stored in the 64 byte history section
+     * at the end of the eeprom.
+     * 
+     * The Xbox does not define the contents of this section, so
+     * EEasyXB lays it out as 16 words. The first word is a header
+     * holding a magic value, the slot the next entry is written to
+     * and the number of entries. The other 15 words are entries.
+     * The section is outside both checksummed ranges, and appending
+     * rewrites only the header and a single entry word.
+     * 
+     */
+    class History
+    {
+    public:
+        /**
+         * @brief Number of entries the section can hold before the
+         * oldest is overwritten.
+         * 
+         */
+        static const unsigned int CAPACITY = 15;
+
+        /**
+         * @brief Checks to see if the history section of an image
+         * holds a ring buffer with a consistent header.
+         * 
+         * @param image Image to check.
+         * @return true If the section has been formatted.
+         * @return false Otherwise.
+         */
+        static bool IsFormatted(const EepromData& image);
+
+        /**
+         * @brief Clear the history section and write an empty ring
+         * buffer to it.
+         * 
+         * @param image Image to format.
+         */
+        static void Format(EepromData& image);
+
+        /**
+         * @brief Get the number of entries in the history.
+         * 
+         * @param image Image to read.
+         * @return unsigned int Number of entries, 0 if the section
+         * is not formatted.
+         */
+        static unsigned int GetCount(const EepromData& image);
+
+        /**
+         * @brief Get one entry of the history.
+         * 
+         * @param image Image to read.
+         * @param index 0 for the oldest entry.
+         * @param outEntry Receives the entry.
+         * @return true If the entry exists.
+         * @return false Otherwise.
+         */
+        static bool Get(const EepromData& image, unsigned int index, HistoryEntry& outEntry);
+
+        /**
+         * @brief Append an entry, overwriting the oldest entry once
+         * the history is full. The section is never formatted
+         * implicitly, since it may hold data EEasyXB does not know
+         * about. Call Format() first to start a history.
+         * 
+         * @param image Image to modify.
+         * @param entry Entry to append.
+         * @return true If the entry was appended.
+         * @return false If the section is not formatted.
+         */
+        static bool Append(EepromData& image, const HistoryEntry& entry);
+
+        /**
+         * @brief Visit every entry of every image in an array.
+         * 
+         * @param images Images to read.
+         * @param count Number of images.
+         * @param visitor Called for each entry.
+         * @param context Passed through to visitor.
+         * @return unsigned long long Number of entries visited.
+         */
+        static unsigned long long Visit(const EepromData* images, unsigned int count,
+                                        HistoryVisitor visitor, void* context);
+
+        /**
+         * @brief Visit every entry of a single image.
+         * 
+         * @param image Image to read.
+         * @param imageIndex Index passed through to visitor.
+         * @param visitor Called for each entry.
+         * @param context Passed through to visitor.
+         * @return unsigned int Number of entries visited.
+         */
+        static unsigned int Visit(const EepromData& image, unsigned int imageIndex,
+                                  HistoryVisitor visitor, void* context);
+
+    private:
+        static const unsigned int MAGIC = 0x4858;   // "XH"
+    };
+} // namespace EEasyXB
+
+#endif // HISTORY_H
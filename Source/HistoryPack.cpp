@@ -0,0 +1,31 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "HistoryPack.h"
+
+namespace EEasyXB
+{
+    unsigned long long HistoryPack::Visit(EepromPackReader& reader, HistoryVisitor visitor, void* context)
+    {
+        unsigned long long visited = 0;
+        unsigned int imageIndex = reader.GetPosition();
+        EepromData image;
+
+        while(reader.Next(image))
+        {
+            visited += History::Visit(image, imageIndex++, visitor, context);
+        }
+
+        return visited;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,45 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef HISTORY_PACK_H
+#define HISTORY_PACK_H
+
+#include "EepromPackReader.h"
+#include "History.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Walks the history sections of archived images stored
+     * in a pack file. Kept apart from EEasyXB::History so the Xbox
+     * build does not depend on the pack reader.
+     * 
+     */
+    class HistoryPack
+    {
+    public:
+        /**
+         * @brief Visit every entry of every remaining image in a
+         * pack, decoding each image into a single reused buffer.
+         * 
+         * @param reader Open pack, read from its current position.
+         * @param visitor Called for each entry, with the index of
+         * the image in the pack.
+         * @param context Passed through to visitor.
+         * @return unsigned long long Number of entries visited.
+         */
+        static unsigned long long Visit(EepromPackReader& reader, HistoryVisitor visitor, void* context);
+    };
+} // namespace EEasyXB
+
+#endif // HISTORY_PACK_H
@@ -0,0 +1,170 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "NetworkProvisioner.h"
+#include "Checksum.h"
+
+namespace EEasyXB
+{
+    namespace
+    {
+        // liveIp through liveSubnet
+        const unsigned int LIVE_SETTINGS_LENGTH = 4 * sizeof(unsigned int);
+
+        // Highest value of the upper half of a user section sum,
+        // one less than its number of words
+        const unsigned int MAX_USER_SUM_HIGH = Checksum::USER_SECTION_LENGTH / sizeof(unsigned int) - 1;
+
+        // Adjusts the user checksum of an image for a change in the
+        // sum of some of its words, without summing the section.
+        //
+        // The checksum folds the high half of the sum into the low
+        // half, so the folded value is known but the split is not.
+        // The high half is at most MAX_USER_SUM_HIGH, and as long as
+        // the change carries the same way for every possible split,
+        // any split gives the right checksum. Otherwise returns
+        // false and the section must be summed.
+        bool AdjustUserChecksum(EepromData& image, unsigned long long oldSum, unsigned long long newSum)
+        {
+            unsigned long long folded = ~image.userChecksum;
+            if(folded < MAX_USER_SUM_HIGH)
+            {
+                return false;
+            }
+
+            // Offset so the ends of the range stay positive
+            unsigned long long offset = 16ULL << 32;
+            unsigned long long highest = offset + folded + newSum - oldSum;
+            unsigned long long lowest = highest - MAX_USER_SUM_HIGH;
+            if((highest >> 32) != (lowest >> 32))
+            {
+                return false;
+            }
+
+            image.userChecksum = Checksum::FromSum(folded + newSum - oldSum);
+            return true;
+        }
+    }
+
+    NetworkProvisioner::NetworkProvisioner(const AddressPlan& plan)
+        : m_plan(plan),
+          m_nextAddress(IpAddress::SwapOrder(plan.firstAddress)),
+          m_collisionCount(0)
+    {
+        Reserve(plan.gateway);
+        Reserve(plan.dnsServer);
+    }
+
+    void NetworkProvisioner::Reserve(unsigned int address)
+    {
+        if(address != 0)
+        {
+            m_usedAddresses.insert(address);
+        }
+    }
+
+    bool NetworkProvisioner::IsInUse(unsigned int address) const
+    {
+        return (m_usedAddresses.find(address) != m_usedAddresses.end());
+    }
+
+    bool NetworkProvisioner::Provision(EepromData* images, unsigned int count)
+    {
+        m_usedAddresses.reserve(m_usedAddresses.size() + count);
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int address;
+            if(!NextFreeAddress(&address))
+            {
+                return false;
+            }
+
+            EepromData& image = images[i];
+            unsigned long long oldSum = Checksum::Sum((const unsigned char*)&(image.liveIp), LIVE_SETTINGS_LENGTH);
+
+            image.liveIp = address;
+            image.liveSubnet = m_plan.subnetMask;
+            image.liveGateway = m_plan.gateway;
+            image.liveDns = m_plan.dnsServer;
+
+            unsigned long long newSum = Checksum::Sum((const unsigned char*)&(image.liveIp), LIVE_SETTINGS_LENGTH);
+            if(!AdjustUserChecksum(image, oldSum, newSum))
+            {
+                Checksum::UpdateUser(image);
+            }
+        }
+
+        return true;
+    }
+
+    unsigned int NetworkProvisioner::GetCollisionCount() const
+    {
+        return m_collisionCount;
+    }
+
+    unsigned int NetworkProvisioner::FindCollisions(const EepromData* images, unsigned int count,
+                                                    unsigned int* outIndices, unsigned int maxIndices)
+    {
+        std::unordered_set<unsigned int> seen;
+        seen.reserve(count);
+        unsigned int collisions = 0;
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int address = images[i].liveIp;
+
+            // 0 means the address comes from DHCP
+            if(address != 0 && !seen.insert(address).second)
+            {
+                if(collisions < maxIndices)
+                {
+                    outIndices[collisions] = i;
+                }
+                collisions++;
+            }
+        }
+
+        return collisions;
+    }
+
+    bool NetworkProvisioner::NextFreeAddress(unsigned int* outAddress)
+    {
+        unsigned int last = IpAddress::SwapOrder(m_plan.lastAddress);
+        unsigned int hostMask = ~IpAddress::SwapOrder(m_plan.subnetMask);
+
+        while(m_nextAddress != 0 && m_nextAddress <= last)
+        {
+            unsigned int candidate = m_nextAddress++;
+            unsigned int hostPart = candidate & hostMask;
+
+            // Skip the network and broadcast addresses of the subnet
+            if(hostMask != 0 && (hostPart == 0 || hostPart == hostMask))
+            {
+                continue;
+            }
+
+            unsigned int address = IpAddress::SwapOrder(candidate);
+            if(!m_usedAddresses.insert(address).second)
+            {
+                m_collisionCount++;
+                continue;
+            }
+
+            *outAddress = address;
+            return true;
+        }
+
+        return false;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,119 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef NETWORK_PROVISIONER_H
+#define NETWORK_PROVISIONER_H
+
+#include <unordered_set>
+
+#include "EepromData.h"
+#include "IpAddress.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Address plan used to provision static network
+     * settings. All addresses use the eeprom encoding described
+     * by EEasyXB::IpAddress.
+     * 
+     */
+    struct AddressPlan
+    {
+        unsigned int firstAddress;  // first address handed out
+        unsigned int lastAddress;   // last address handed out, inclusive
+        unsigned int subnetMask;
+        unsigned int gateway;
+        unsigned int dnsServer;
+    };
+
+    /**
+     * @brief Assigns unique static addresses from an address plan
+     * to a set of eeprom images and rewrites their user checksums.
+     * 
+     */
+    class NetworkProvisioner
+    {
+    public:
+        /**
+         * @brief Construct a provisioner for an address plan. The
+         * gateway and DNS server are reserved automatically.
+         * 
+         * @param plan Addresses to hand out.
+         */
+        explicit NetworkProvisioner(const AddressPlan& plan);
+
+        /**
+         * @brief Prevent an address from being handed out, for
+         * example one already used by another host.
+         * 
+         * @param address Address in the eeprom encoding.
+         */
+        void Reserve(unsigned int address);
+
+        /**
+         * @brief Checks to see if an address is reserved or has
+         * already been handed out.
+         * 
+         * @param address Address in the eeprom encoding.
+         * @return true If the address is in use.
+         * @return false Otherwise.
+         */
+        bool IsInUse(unsigned int address) const;
+
+        /**
+         * @brief Assign an address and the plan's network settings
+         * to each image. The user checksum is adjusted for the
+         * changed words rather than recalculated, so images must
+         * start with a valid user checksum.
+         * 
+         * @param images Images to provision.
+         * @param count Number of images.
+         * @return true If every image received an address.
+         * @return false If the plan ran out of addresses. Images
+         * before the failing one are left provisioned.
+         */
+        bool Provision(EepromData* images, unsigned int count);
+
+        /**
+         * @brief Get the number of addresses that were skipped
+         * because they were already in use.
+         * 
+         * @return unsigned int Number of collisions seen so far.
+         */
+        unsigned int GetCollisionCount() const;
+
+        /**
+         * @brief Find images that share a static address with an
+         * earlier image. Images using DHCP are ignored.
+         * 
+         * @param images Images to check.
+         * @param count Number of images.
+         * @param outIndices Receives the index of each duplicate.
+         * @param maxIndices Size of outIndices.
+         * @return unsigned int Total number of duplicates found,
+         * which may exceed maxIndices.
+         */
+        static unsigned int FindCollisions(const EepromData* images, unsigned int count,
+                                           unsigned int* outIndices, unsigned int maxIndices);
+
+    private:
+        AddressPlan m_plan;
+        unsigned int m_nextAddress;     // first octet most significant
+        unsigned int m_collisionCount;
+        std::unordered_set<unsigned int> m_usedAddresses;
+
+        bool NextFreeAddress(unsigned int* outAddress);
+    };
+} // namespace EEasyXB
+
+#endif // NETWORK_PROVISIONER_H
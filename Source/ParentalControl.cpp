@@ -0,0 +1,113 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ParentalControl.h"
+
+namespace EEasyXB
+{
+    namespace
+    {
+        // Images checked per pass before collecting violators
+        const unsigned int BATCH_SIZE = 256;
+    }
+
+    bool ParentalControl::DecodePasscode(unsigned int rawPasscode, PasscodeButton* outButtons)
+    {
+        for(unsigned int i = 0; i < PASSCODE_LENGTH; ++i)
+        {
+            unsigned int shift = (PASSCODE_LENGTH - 1 - i) * 4;
+            outButtons[i] = (PasscodeButton)((rawPasscode >> shift) & 0x0F);
+        }
+
+        return (rawPasscode != 0);
+    }
+
+    unsigned int ParentalControl::EncodePasscode(const PasscodeButton* buttons)
+    {
+        unsigned int rawPasscode = 0;
+
+        if(buttons)
+        {
+            for(unsigned int i = 0; i < PASSCODE_LENGTH; ++i)
+            {
+                rawPasscode = (rawPasscode << 4) | ((unsigned int)buttons[i] & 0x0F);
+            }
+        }
+
+        return rawPasscode;
+    }
+
+    unsigned int ParentalControl::Check(const EepromData& image, const ParentalControlPolicy& policy)
+    {
+        ParentalControlViolator violator;
+        return (Audit(&image, 1, policy, &violator, 1) != 0) ? violator.violations : 0;
+    }
+
+    unsigned int ParentalControl::Audit(const EepromData* images, unsigned int count,
+                                        const ParentalControlPolicy& policy,
+                                        ParentalControlViolator* outViolators, unsigned int maxViolators)
+    {
+        const unsigned int minimumGame = (unsigned int)policy.minimumGameRating;
+        const unsigned int minimumMovie = (unsigned int)policy.minimumMovieRating;
+        const unsigned int requirePasscode = policy.requirePasscode ? 1 : 0;
+        const unsigned int expectedPasscode = policy.expectedPasscode;
+        const unsigned int checkPasscode = (expectedPasscode != 0) ? 1 : 0;
+
+        unsigned int games[BATCH_SIZE];
+        unsigned int movies[BATCH_SIZE];
+        unsigned int passcodes[BATCH_SIZE];
+        unsigned char flags[BATCH_SIZE];
+        unsigned int violators = 0;
+
+        for(unsigned int first = 0; first < count; first += BATCH_SIZE)
+        {
+            unsigned int batchCount = (count - first < BATCH_SIZE) ? count - first : BATCH_SIZE;
+            const EepromData* batch = images + first;
+
+            // Images are far apart, so gather the three fields into
+            // contiguous arrays first
+            for(unsigned int i = 0; i < batchCount; ++i)
+            {
+                games[i] = batch[i].parentalControlGame;
+                movies[i] = batch[i].parentalControlMovie;
+                passcodes[i] = batch[i].parentalControlPasscode;
+            }
+
+            // Branch free over the arrays so the compiler can
+            // vectorize the checks
+            for(unsigned int i = 0; i < batchCount; ++i)
+            {
+                flags[i] = (unsigned char)(
+                    ((games[i] < minimumGame) ? VIOLATION_GAME_RATING : 0) |
+                    ((movies[i] < minimumMovie) ? VIOLATION_MOVIE_RATING : 0) |
+                    ((requirePasscode & (passcodes[i] == 0)) ? VIOLATION_NO_PASSCODE : 0) |
+                    ((checkPasscode & (passcodes[i] != expectedPasscode)) ? VIOLATION_WRONG_PASSCODE : 0));
+            }
+
+            for(unsigned int i = 0; i < batchCount; ++i)
+            {
+                if(flags[i] != 0)
+                {
+                    if(violators < maxViolators)
+                    {
+                        outViolators[violators].index = first + i;
+                        outViolators[violators].violations = flags[i];
+                    }
+                    violators++;
+                }
+            }
+        }
+
+        return violators;
+    }
+} // namespace EEasyXB
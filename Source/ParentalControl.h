@@ -0,0 +1,122 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef PARENTAL_CONTROL_H
+#define PARENTAL_CONTROL_H
+
+#include "EepromData.h"
+#include "Enums.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Settings every audited image must meet.
+     * 
+     */
+    struct ParentalControlPolicy
+    {
+        GameRating minimumGameRating;       // image must be at least this restrictive
+        MovieRating minimumMovieRating;     // image must be at least this restrictive
+        bool requirePasscode;
+        unsigned int expectedPasscode;      // raw passcode to match, 0 to accept any
+    };
+
+    /**
+     * @brief Reasons an image failed a parental control audit.
+     * 
+     */
+    enum ParentalControlViolation
+    {
+        VIOLATION_GAME_RATING = 0x01,
+        VIOLATION_MOVIE_RATING = 0x02,
+        VIOLATION_NO_PASSCODE = 0x04,
+        VIOLATION_WRONG_PASSCODE = 0x08
+    };
+
+    /**
+     * @brief One image that failed a parental control audit.
+     * 
+     */
+    struct ParentalControlViolator
+    {
+        unsigned int index;         // index of the image in the audited array
+        unsigned int violations;    // EEasyXB::ParentalControlViolation flags
+    };
+
+    /**
+     * @brief Decoding of the parental control passcode and audits
+     * of parental control settings across many images.
+     * 
+     * The passcode is stored as up to four EEasyXB::PasscodeButton
+     * values, one per nibble, with the first button in the most
+     * significant nibble of the low 16 bits. A value of 0 means no
+     * passcode is set.
+     * 
+     */
+    class ParentalControl
+    {
+    public:
+        /**
+         * @brief Number of buttons in a passcode.
+         * 
+         */
+        static const unsigned int PASSCODE_LENGTH = 4;
+
+        /**
+         * @brief Decode a raw passcode into its buttons.
+         * 
+         * @param rawPasscode Value of parentalControlPasscode.
+         * @param outButtons Receives PASSCODE_LENGTH buttons.
+         * @return true If a passcode is set.
+         * @return false Otherwise.
+         */
+        static bool DecodePasscode(unsigned int rawPasscode, PasscodeButton* outButtons);
+
+        /**
+         * @brief Encode a button sequence as a raw passcode.
+         * 
+         * @param buttons PASSCODE_LENGTH buttons, or NULL for no
+         * passcode.
+         * @return unsigned int Value for parentalControlPasscode.
+         */
+        static unsigned int EncodePasscode(const PasscodeButton* buttons);
+
+        /**
+         * @brief Check a single image against a policy.
+         * 
+         * @param image Image to check.
+         * @param policy Policy to check against.
+         * @return unsigned int EEasyXB::ParentalControlViolation
+         * flags, 0 if the image complies.
+         */
+        static unsigned int Check(const EepromData& image, const ParentalControlPolicy& policy);
+
+        /**
+         * @brief Check many images against a policy and report the
+         * ones that do not comply.
+         * 
+         * @param images Images to check.
+         * @param count Number of images.
+         * @param policy Policy to check against.
+         * @param outViolators Receives the violators in index order.
+         * @param maxViolators Size of outViolators.
+         * @return unsigned int Total number of violators, which may
+         * exceed maxViolators.
+         */
+        static unsigned int Audit(const EepromData* images, unsigned int count,
+                                  const ParentalControlPolicy& policy,
+                                  ParentalControlViolator* outViolators, unsigned int maxViolators);
+    };
+} // namespace EEasyXB
+
+#endif // PARENTAL_CONTROL_H
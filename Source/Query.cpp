@@ -0,0 +1,262 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Query.h"
+
+namespace EEasyXB
+{
+    Query::Query()
+        : m_stackDepth(0)
+    {
+
+    }
+
+    Query Query::Field(unsigned int EepromData::* field, QueryComparison comparison,
+                       unsigned int value, unsigned int mask)
+    {
+        Instruction instruction;
+        instruction.opcode = OP_TEST;
+        instruction.comparison = comparison;
+        instruction.field = field;
+        instruction.mask = mask;
+        instruction.value = value & mask;
+
+        Query query;
+        query.m_program.push_back(instruction);
+        query.m_stackDepth = 1;
+        return query;
+    }
+
+    Query Query::ResolutionEnabled(SupportedResolution resolution)
+    {
+        return Field(&EepromData::videoSettings, COMPARE_NOT_EQUAL, 0, (unsigned int)resolution);
+    }
+
+    Query Query::AudioModeEnabled(AudioMode audioMode)
+    {
+        if(audioMode == AudioMode::STEREO)
+        {
+            return Field(&EepromData::audioSettings, COMPARE_EQUAL, 0,
+                         AudioMode::MONO | AudioMode::SURROUND);
+        }
+
+        return Field(&EepromData::audioSettings, COMPARE_NOT_EQUAL, 0, (unsigned int)audioMode);
+    }
+
+    Query Query::AspectRatioEnabled(AspectRatio aspectRatio)
+    {
+        if(aspectRatio == AspectRatio::NORMAL)
+        {
+            return Field(&EepromData::videoSettings, COMPARE_EQUAL, 0,
+                         AspectRatio::WIDESCREEN | AspectRatio::LETTERBOX);
+        }
+
+        return Field(&EepromData::videoSettings, COMPARE_NOT_EQUAL, 0, (unsigned int)aspectRatio);
+    }
+
+    Query Query::And(const Query& other) const
+    {
+        return Combine(other, OP_AND);
+    }
+
+    Query Query::Or(const Query& other) const
+    {
+        return Combine(other, OP_OR);
+    }
+
+    Query Query::Not() const
+    {
+        Instruction instruction = Instruction();
+        instruction.opcode = OP_NOT;
+
+        Query query = *this;
+        query.m_program.push_back(instruction);
+        return query;
+    }
+
+    bool Query::Matches(const EepromData& image) const
+    {
+        return Evaluate(&image, 1) != 0;
+    }
+
+    unsigned int Query::Evaluate(const EepromData* images, unsigned int count, unsigned char* outMatches) const
+    {
+        std::vector<unsigned int> values(BATCH_SIZE);
+        std::vector<unsigned char> stack(m_stackDepth * BATCH_SIZE);
+        unsigned int matches = 0;
+
+        for(unsigned int first = 0; first < count; first += BATCH_SIZE)
+        {
+            unsigned int batchCount = (count - first < BATCH_SIZE) ? count - first : BATCH_SIZE;
+            EvaluateBatch(images + first, batchCount, values.data(), stack.data());
+
+            // The result is left at the bottom of the stack
+            for(unsigned int i = 0; i < batchCount; ++i)
+            {
+                matches += stack[i];
+            }
+
+            if(outMatches)
+            {
+                for(unsigned int i = 0; i < batchCount; ++i)
+                {
+                    outMatches[first + i] = stack[i];
+                }
+            }
+        }
+
+        return matches;
+    }
+
+    unsigned int Query::Find(const EepromData* images, unsigned int count,
+                             unsigned int* outIndices, unsigned int maxIndices) const
+    {
+        std::vector<unsigned int> values(BATCH_SIZE);
+        std::vector<unsigned char> stack(m_stackDepth * BATCH_SIZE);
+        unsigned int matches = 0;
+
+        for(unsigned int first = 0; first < count; first += BATCH_SIZE)
+        {
+            unsigned int batchCount = (count - first < BATCH_SIZE) ? count - first : BATCH_SIZE;
+            EvaluateBatch(images + first, batchCount, values.data(), stack.data());
+
+            for(unsigned int i = 0; i < batchCount; ++i)
+            {
+                if(stack[i])
+                {
+                    if(matches < maxIndices)
+                    {
+                        outIndices[matches] = first + i;
+                    }
+                    matches++;
+                }
+            }
+        }
+
+        return matches;
+    }
+
+    Query Query::Combine(const Query& other, Opcode opcode) const
+    {
+        Instruction instruction = Instruction();
+        instruction.opcode = opcode;
+
+        Query query = *this;
+        query.m_program.insert(query.m_program.end(), other.m_program.begin(), other.m_program.end());
+        query.m_program.push_back(instruction);
+
+        // The right hand side is evaluated with the left hand
+        // result still on the stack.
+        unsigned int otherDepth = other.m_stackDepth + 1;
+        query.m_stackDepth = (m_stackDepth > otherDepth) ? m_stackDepth : otherDepth;
+        return query;
+    }
+
+    void Query::EvaluateBatch(const EepromData* images, unsigned int count, unsigned int* values,
+                              unsigned char* stack) const
+    {
+        unsigned char* top = stack;     // one past the last pushed lane array
+
+        for(unsigned int pc = 0; pc < m_program.size(); ++pc)
+        {
+            const Instruction& instruction = m_program[pc];
+
+            switch(instruction.opcode)
+            {
+                case OP_TEST:
+                {
+                    unsigned char* lanes = top;
+                    unsigned int EepromData::* field = instruction.field;
+                    unsigned int mask = instruction.mask;
+                    unsigned int value = instruction.value;
+
+                    // Images are far apart, so gather the field into
+                    // a contiguous array first. The compares below
+                    // then vectorize over it.
+                    for(unsigned int i = 0; i < count; ++i)
+                    {
+                        values[i] = images[i].*field;
+                    }
+
+                    switch(instruction.comparison)
+                    {
+                        case COMPARE_EQUAL:
+                        {
+                            for(unsigned int i = 0; i < count; ++i)
+                            {
+                                lanes[i] = (unsigned char)((values[i] & mask) == value);
+                            }
+                            break;
+                        }
+                        case COMPARE_NOT_EQUAL:
+                        {
+                            for(unsigned int i = 0; i < count; ++i)
+                            {
+                                lanes[i] = (unsigned char)((values[i] & mask) != value);
+                            }
+                            break;
+                        }
+                        case COMPARE_LESS:
+                        {
+                            for(unsigned int i = 0; i < count; ++i)
+                            {
+                                lanes[i] = (unsigned char)((values[i] & mask) < value);
+                            }
+                            break;
+                        }
+                        case COMPARE_GREATER:
+                        {
+                            for(unsigned int i = 0; i < count; ++i)
+                            {
+                                lanes[i] = (unsigned char)((values[i] & mask) > value);
+                            }
+                            break;
+                        }
+                    }
+
+                    top += BATCH_SIZE;
+                    break;
+                }
+                case OP_AND:
+                {
+                    top -= BATCH_SIZE;
+                    unsigned char* left = top - BATCH_SIZE;
+                    for(unsigned int i = 0; i < count; ++i)
+                    {
+                        left[i] &= top[i];
+                    }
+                    break;
+                }
+                case OP_OR:
+                {
+                    top -= BATCH_SIZE;
+                    unsigned char* left = top - BATCH_SIZE;
+                    for(unsigned int i = 0; i < count; ++i)
+                    {
+                        left[i] |= top[i];
+                    }
+                    break;
+                }
+                case OP_NOT:
+                {
+                    unsigned char* operand = top - BATCH_SIZE;
+                    for(unsigned int i = 0; i < count; ++i)
+                    {
+                        operand[i] ^= 1;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+} // namespace EEasyXB
@@ -0,0 +1,180 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <vector>
+
+#include "EepromData.h"
+#include "Enums.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Comparison applied to a masked eeprom field.
+     * 
+     */
+    enum QueryComparison
+    {
+        COMPARE_EQUAL = 0,
+        COMPARE_NOT_EQUAL,
+        COMPARE_LESS,
+        COMPARE_GREATER
+    };
+
+    /**
+     * @brief Predicate over eeprom images, built from field
+     * comparisons combined with And, Or and Not.
+     * 
+     * A query is compiled as it is built into a postfix program of
+     * mask and compare tests. Evaluation runs each instruction over
+     * a batch of images at a time. A test first copies its field
+     * from each image into a contiguous array, then masks and
+     * compares that array in a branch free loop the compiler can
+     * vectorize. The And, Or and Not loops work the same way on
+     * the byte lanes of the stack.
+     * 
+     * @code
+     * Query query = Query::ResolutionEnabled(RESOLUTION_720p)
+     *     .And(Query::AspectRatioEnabled(WIDESCREEN).Not())
+     *     .And(Query::Field(&EepromData::dvdZone, COMPARE_EQUAL, 1))
+     *     .And(Query::Field(&EepromData::language, COMPARE_EQUAL, LANGUAGE_ENGLISH));
+     * @endcode
+     * 
+     */
+    class Query
+    {
+    public:
+        /**
+         * @brief Compare a field of the image.
+         * 
+         * @param field Field to test, for example &EepromData::dvdZone.
+         * @param comparison How to compare the field with value.
+         * @param value Value to compare against.
+         * @param mask Bits of the field to compare.
+         * @return Query Single comparison query.
+         */
+        static Query Field(unsigned int EepromData::* field, QueryComparison comparison,
+                           unsigned int value, unsigned int mask = 0xFFFFFFFF);
+
+        /**
+         * @brief Match images with a resolution enabled. Same
+         * semantics as Eeprom::IsResolutionEnabled().
+         * 
+         * @param resolution Resolution to test.
+         * @return Query Single comparison query.
+         */
+        static Query ResolutionEnabled(SupportedResolution resolution);
+
+        /**
+         * @brief Match images with an audio mode enabled. Same
+         * semantics as Eeprom::IsAudioModeEnabled().
+         * 
+         * @param audioMode Audio mode to test.
+         * @return Query Single comparison query.
+         */
+        static Query AudioModeEnabled(AudioMode audioMode);
+
+        /**
+         * @brief Match images with an aspect ratio enabled. Same
+         * semantics as Eeprom::IsAspectRatioEnabled().
+         * 
+         * @param aspectRatio Aspect ratio to test.
+         * @return Query Single comparison query.
+         */
+        static Query AspectRatioEnabled(AspectRatio aspectRatio);
+
+        /**
+         * @brief Match images matched by both queries.
+         * 
+         */
+        Query And(const Query& other) const;
+
+        /**
+         * @brief Match images matched by either query.
+         * 
+         */
+        Query Or(const Query& other) const;
+
+        /**
+         * @brief Match images not matched by this query.
+         * 
+         */
+        Query Not() const;
+
+        /**
+         * @brief Checks to see if a single image matches.
+         * 
+         * @param image Image to test.
+         * @return true If the image matches.
+         * @return false Otherwise.
+         */
+        bool Matches(const EepromData& image) const;
+
+        /**
+         * @brief Evaluate the query over an array of images.
+         * 
+         * @param images Images to test.
+         * @param count Number of images.
+         * @param outMatches Optional, receives 1 for each image
+         * that matches and 0 otherwise.
+         * @return unsigned int Number of matching images.
+         */
+        unsigned int Evaluate(const EepromData* images, unsigned int count, unsigned char* outMatches = 0) const;
+
+        /**
+         * @brief Find the images that match the query.
+         * 
+         * @param images Images to test.
+         * @param count Number of images.
+         * @param outIndices Receives the index of each match.
+         * @param maxIndices Size of outIndices.
+         * @return unsigned int Total number of matches, which may
+         * exceed maxIndices.
+         */
+        unsigned int Find(const EepromData* images, unsigned int count,
+                          unsigned int* outIndices, unsigned int maxIndices) const;
+
+    private:
+        enum Opcode
+        {
+            OP_TEST = 0,
+            OP_AND,
+            OP_OR,
+            OP_NOT
+        };
+
+        struct Instruction
+        {
+            Opcode opcode;
+            QueryComparison comparison;
+            unsigned int EepromData::* field;
+            unsigned int mask;
+            unsigned int value;
+        };
+
+        // Images evaluated per pass over the program
+        static const unsigned int BATCH_SIZE = 256;
+
+        std::vector<Instruction> m_program;     // postfix
+        unsigned int m_stackDepth;
+
+        Query();
+        Query Combine(const Query& other, Opcode opcode) const;
+        void EvaluateBatch(const EepromData* images, unsigned int count, unsigned int* values,
+                           unsigned char* stack) const;
+    };
+} // namespace EEasyXB
+
+#endif // QUERY_H
@@ -0,0 +1,745 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Serializer.h"
+#include "Checksum.h"
+#include "Enums.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        enum FieldType
+        {
+            FIELD_UINT = 0,     // unsigned 32 bit number
+            FIELD_INT,          // signed 32 bit number
+            FIELD_HEX,          // byte array as a hex string
+            FIELD_STRING,       // character array as a string
+            FIELD_MAC           // MAC address as aa:bb:cc:dd:ee:ff
+        };
+
+        struct FieldInfo
+        {
+            const char* name;
+            FieldType type;
+            unsigned int offset;
+            unsigned int size;
+        };
+
+        #define EEASYXB_FIELD(name, type) { #name, type, offsetof(EepromData, name), sizeof(((EepromData*)0)->name) }
+
+        const FieldInfo FIELDS[] =
+        {
+            EEASYXB_FIELD(hmacSha1Hash, FIELD_HEX),
+            EEASYXB_FIELD(confounder, FIELD_HEX),
+            EEASYXB_FIELD(hddKey, FIELD_HEX),
+            EEASYXB_FIELD(regionFlags, FIELD_UINT),
+            EEASYXB_FIELD(factoryChecksum, FIELD_UINT),
+            EEASYXB_FIELD(serial, FIELD_STRING),
+            EEASYXB_FIELD(macAddress, FIELD_MAC),
+            EEASYXB_FIELD(padding46, FIELD_HEX),
+            EEASYXB_FIELD(onlineKey, FIELD_HEX),
+            EEASYXB_FIELD(videoStandardFlags, FIELD_UINT),
+            EEASYXB_FIELD(padding5C, FIELD_UINT),
+            EEASYXB_FIELD(userChecksum, FIELD_UINT),
+            EEASYXB_FIELD(timeZoneBias, FIELD_INT),
+            EEASYXB_FIELD(timeZoneStandardName, FIELD_STRING),
+            EEASYXB_FIELD(timeZoneDaylightName, FIELD_STRING),
+            EEASYXB_FIELD(padding70, FIELD_HEX),
+            EEASYXB_FIELD(timeZoneStandardStarts, FIELD_UINT),
+            EEASYXB_FIELD(timeZoneDaylightStarts, FIELD_UINT),
+            EEASYXB_FIELD(padding80, FIELD_HEX),
+            EEASYXB_FIELD(timeZoneStandardBias, FIELD_INT),
+            EEASYXB_FIELD(timeZoneDaylightBias, FIELD_INT),
+            EEASYXB_FIELD(language, FIELD_UINT),
+            EEASYXB_FIELD(videoSettings, FIELD_UINT),
+            EEASYXB_FIELD(audioSettings, FIELD_UINT),
+            EEASYXB_FIELD(parentalControlGame, FIELD_UINT),
+            EEASYXB_FIELD(parentalControlPasscode, FIELD_UINT),
+            EEASYXB_FIELD(parentalControlMovie, FIELD_UINT),
+            EEASYXB_FIELD(liveIp, FIELD_UINT),
+            EEASYXB_FIELD(liveDns, FIELD_UINT),
+            EEASYXB_FIELD(liveGateway, FIELD_UINT),
+            EEASYXB_FIELD(liveSubnet, FIELD_UINT),
+            EEASYXB_FIELD(unknownB8, FIELD_UINT),
+            EEASYXB_FIELD(dvdZone, FIELD_UINT),
+            EEASYXB_FIELD(history, FIELD_HEX)
+        };
+
+        #undef EEASYXB_FIELD
+
+        const unsigned int FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+        const char* LANGUAGE_NAMES[] =
+        {
+            "NOT_SET", "ENGLISH", "JAPANESE", "GERMAN", "FRENCH",
+            "SPANISH", "ITALIAN", "KOREAN", "CHINESE", "PORTUGUESE"
+        };
+
+        const char HEX_DIGITS[] = "0123456789abcdef";
+
+        const unsigned char BINARY_MAGIC = 0xEB;
+        const unsigned char BINARY_VERSION = 1;
+        const unsigned char BINARY_FACTORY_VALID = 0x01;
+        const unsigned char BINARY_USER_VALID = 0x02;
+
+        // Appends to a fixed buffer, remembering if it ran out of room
+        class JsonWriter
+        {
+        public:
+            JsonWriter(char* buffer, unsigned int size)
+                : m_buffer(buffer), m_size(size), m_length(0), m_overflow(false)
+            {
+            }
+
+            void Char(char c)
+            {
+                // Always keep room for the terminator
+                if(m_length + 1 < m_size)
+                {
+                    m_buffer[m_length++] = c;
+                }
+                else
+                {
+                    m_overflow = true;
+                }
+            }
+
+            void Text(const char* text)
+            {
+                while(*text)
+                {
+                    Char(*text++);
+                }
+            }
+
+            void Key(const char* name, bool first = false)
+            {
+                if(!first)
+                {
+                    Char(',');
+                }
+                Char('"');
+                Text(name);
+                Text("\":");
+            }
+
+            void Unsigned(unsigned int value)
+            {
+                char digits[10];
+                unsigned int count = 0;
+                do
+                {
+                    digits[count++] = (char)('0' + value % 10);
+                    value /= 10;
+                } while(value != 0);
+
+                while(count > 0)
+                {
+                    Char(digits[--count]);
+                }
+            }
+
+            void Signed(int value)
+            {
+                if(value < 0)
+                {
+                    Char('-');
+                    Unsigned(0u - (unsigned int)value);
+                }
+                else
+                {
+                    Unsigned((unsigned int)value);
+                }
+            }
+
+            void Hex(const unsigned char* bytes, unsigned int size, char separator = 0)
+            {
+                Char('"');
+                for(unsigned int i = 0; i < size; ++i)
+                {
+                    if(separator && i != 0)
+                    {
+                        Char(separator);
+                    }
+                    Char(HEX_DIGITS[bytes[i] >> 4]);
+                    Char(HEX_DIGITS[bytes[i] & 0x0F]);
+                }
+                Char('"');
+            }
+
+            void String(const char* chars, unsigned int size)
+            {
+                // Trailing nulls are padding, restored on parse
+                while(size > 0 && chars[size - 1] == 0)
+                {
+                    size--;
+                }
+
+                Char('"');
+                for(unsigned int i = 0; i < size; ++i)
+                {
+                    unsigned char c = (unsigned char)chars[i];
+                    if(c == '"' || c == '\\')
+                    {
+                        Char('\\');
+                        Char((char)c);
+                    }
+                    else if(c < 0x20 || c >= 0x7F)
+                    {
+                        Text("\\u00");
+                        Char(HEX_DIGITS[c >> 4]);
+                        Char(HEX_DIGITS[c & 0x0F]);
+                    }
+                    else
+                    {
+                        Char((char)c);
+                    }
+                }
+                Char('"');
+            }
+
+            unsigned int Finish()
+            {
+                if(m_overflow || m_size == 0)
+                {
+                    return 0;
+                }
+
+                m_buffer[m_length] = 0;
+                return m_length;
+            }
+
+        private:
+            char* m_buffer;
+            unsigned int m_size;
+            unsigned int m_length;
+            bool m_overflow;
+        };
+
+        // Reads from a fixed buffer, no allocation
+        class JsonReader
+        {
+        public:
+            JsonReader(const char* json, unsigned int length)
+                : m_json(json), m_length(length), m_position(0)
+            {
+            }
+
+            void SkipWhitespace()
+            {
+                while(m_position < m_length &&
+                      (m_json[m_position] == ' ' || m_json[m_position] == '\t' ||
+                       m_json[m_position] == '\n' || m_json[m_position] == '\r'))
+                {
+                    m_position++;
+                }
+            }
+
+            bool Peek(char c)
+            {
+                SkipWhitespace();
+                return (m_position < m_length && m_json[m_position] == c);
+            }
+
+            bool Expect(char c)
+            {
+                if(Peek(c))
+                {
+                    m_position++;
+                    return true;
+                }
+                return false;
+            }
+
+            // Reads a string into outChars, at most size bytes,
+            // zero filling the rest. Longer strings fail.
+            bool String(char* outChars, unsigned int size, unsigned int* outLength = 0)
+            {
+                if(!Expect('"'))
+                {
+                    return false;
+                }
+
+                unsigned int count = 0;
+                while(m_position < m_length && m_json[m_position] != '"')
+                {
+                    unsigned char c = (unsigned char)m_json[m_position++];
+
+                    if(c == '\\')
+                    {
+                        if(m_position >= m_length)
+                        {
+                            return false;
+                        }
+
+                        char escape = m_json[m_position++];
+                        switch(escape)
+                        {
+                            case 'n': c = '\n'; break;
+                            case 't': c = '\t'; break;
+                            case 'r': c = '\r'; break;
+                            case 'b': c = '\b'; break;
+                            case 'f': c = '\f'; break;
+                            case 'u':
+                            {
+                                unsigned int value = 0;
+                                for(unsigned int i = 0; i < 4; ++i)
+                                {
+                                    int digit = (m_position < m_length) ? HexValue(m_json[m_position++]) : -1;
+                                    if(digit < 0)
+                                    {
+                                        return false;
+                                    }
+                                    value = (value << 4) | (unsigned int)digit;
+                                }
+                                if(value > 0xFF)
+                                {
+                                    return false;
+                                }
+                                c = (unsigned char)value;
+                                break;
+                            }
+                            default: c = (unsigned char)escape; break;
+                        }
+                    }
+
+                    if(outChars)
+                    {
+                        if(count >= size)
+                        {
+                            return false;
+                        }
+                        outChars[count] = (char)c;
+                    }
+                    count++;
+                }
+
+                if(m_position >= m_length)
+                {
+                    return false;
+                }
+                m_position++;
+
+                if(outChars)
+                {
+                    for(unsigned int i = count; i < size; ++i)
+                    {
+                        outChars[i] = 0;
+                    }
+                }
+                if(outLength)
+                {
+                    *outLength = count;
+                }
+
+                return true;
+            }
+
+            // Reads an object key into outKey, null terminated.
+            // Keys that do not fit are skipped and come back empty,
+            // which matches no field.
+            bool Key(char* outKey, unsigned int size)
+            {
+                unsigned int start = m_position;
+                if(String(outKey, size - 1))
+                {
+                    outKey[size - 1] = 0;
+                    return true;
+                }
+
+                m_position = start;
+                outKey[0] = 0;
+                return String(0, 0);
+            }
+
+            bool Number(long long* outValue)
+            {
+                SkipWhitespace();
+
+                bool negative = false;
+                if(m_position < m_length && m_json[m_position] == '-')
+                {
+                    negative = true;
+                    m_position++;
+                }
+
+                unsigned int start = m_position;
+                long long value = 0;
+                while(m_position < m_length && m_json[m_position] >= '0' && m_json[m_position] <= '9')
+                {
+                    value = value * 10 + (m_json[m_position++] - '0');
+                    if(value > 0xFFFFFFFFLL)
+                    {
+                        return false;
+                    }
+                }
+
+                if(m_position == start)
+                {
+                    return false;
+                }
+
+                *outValue = negative ? -value : value;
+                return true;
+            }
+
+            // Hex string of exactly size bytes, optionally separated
+            bool Hex(unsigned char* outBytes, unsigned int size, char separator = 0)
+            {
+                char text[3 * 64];
+                unsigned int length;
+                unsigned int stride = separator ? 3 : 2;
+
+                if(size * stride > sizeof(text) || !String(text, sizeof(text), &length) ||
+                   length != size * stride - (separator ? 1 : 0))
+                {
+                    return false;
+                }
+
+                for(unsigned int i = 0; i < size; ++i)
+                {
+                    int high = HexValue(text[i * stride]);
+                    int low = HexValue(text[i * stride + 1]);
+                    if(high < 0 || low < 0)
+                    {
+                        return false;
+                    }
+                    outBytes[i] = (unsigned char)((high << 4) | low);
+                }
+
+                return true;
+            }
+
+            bool SkipValue(unsigned int depth = 0)
+            {
+                if(depth > 16)
+                {
+                    return false;
+                }
+
+                SkipWhitespace();
+                if(m_position >= m_length)
+                {
+                    return false;
+                }
+
+                char c = m_json[m_position];
+                if(c == '"')
+                {
+                    return String(0, 0);
+                }
+                if(c == '{' || c == '[')
+                {
+                    char close = (c == '{') ? '}' : ']';
+                    m_position++;
+                    if(Expect(close))
+                    {
+                        return true;
+                    }
+
+                    do
+                    {
+                        if(c == '{' && (!String(0, 0) || !Expect(':')))
+                        {
+                            return false;
+                        }
+                        if(!SkipValue(depth + 1))
+                        {
+                            return false;
+                        }
+                    } while(Expect(','));
+
+                    return Expect(close);
+                }
+                if(c == '-' || (c >= '0' && c <= '9'))
+                {
+                    long long ignored;
+                    return Number(&ignored);
+                }
+
+                const char* literals[] = { "true", "false", "null" };
+                for(unsigned int i = 0; i < 3; ++i)
+                {
+                    unsigned int literalLength = (unsigned int)strlen(literals[i]);
+                    if(m_length - m_position >= literalLength &&
+                       strncmp(m_json + m_position, literals[i], literalLength) == 0)
+                    {
+                        m_position += literalLength;
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+        private:
+            const char* m_json;
+            unsigned int m_length;
+            unsigned int m_position;
+
+            static int HexValue(char c)
+            {
+                if(c >= '0' && c <= '9') return c - '0';
+                if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
+            }
+        };
+    }
+
+    unsigned int Serializer::ToJson(const EepromData& image, char* outBuffer, unsigned int bufferSize)
+    {
+        JsonWriter writer(outBuffer, bufferSize);
+        const unsigned char* bytes = (const unsigned char*)&image;
+
+        writer.Char('{');
+        for(unsigned int i = 0; i < FIELD_COUNT; ++i)
+        {
+            const FieldInfo& field = FIELDS[i];
+            const unsigned char* value = bytes + field.offset;
+
+            writer.Key(field.name, i == 0);
+            switch(field.type)
+            {
+                case FIELD_UINT:
+                {
+                    writer.Unsigned(*(const unsigned int*)value);
+                    break;
+                }
+                case FIELD_INT:
+                {
+                    writer.Signed(*(const int*)value);
+                    break;
+                }
+                case FIELD_HEX:
+                {
+                    writer.Hex(value, field.size);
+                    break;
+                }
+                case FIELD_STRING:
+                {
+                    writer.String((const char*)value, field.size);
+                    break;
+                }
+                case FIELD_MAC:
+                {
+                    writer.Hex(value, field.size, ':');
+                    break;
+                }
+            }
+        }
+
+        // Decoded values, for readers that do not know the bit layout
+        writer.Key("factoryChecksumValid");
+        writer.Text(Checksum::IsFactoryValid(image) ? "true" : "false");
+        writer.Key("userChecksumValid");
+        writer.Text(Checksum::IsUserValid(image) ? "true" : "false");
+
+        writer.Key("languageName");
+        writer.Char('"');
+        writer.Text(image.language < sizeof(LANGUAGE_NAMES) / sizeof(LANGUAGE_NAMES[0]) ?
+                    LANGUAGE_NAMES[image.language] : "UNKNOWN");
+        writer.Char('"');
+
+        writer.Key("resolutions");
+        writer.Char('[');
+        bool first = true;
+        if(image.videoSettings & SupportedResolution::RESOLUTION_480p)
+        {
+            writer.Text("\"480p\"");
+            first = false;
+        }
+        if(image.videoSettings & SupportedResolution::RESOLUTION_720p)
+        {
+            writer.Text(first ? "\"720p\"" : ",\"720p\"");
+            first = false;
+        }
+        if(image.videoSettings & SupportedResolution::RESOLUTION_1080i)
+        {
+            writer.Text(first ? "\"1080i\"" : ",\"1080i\"");
+        }
+        writer.Char(']');
+
+        writer.Key("aspectRatio");
+        if(image.videoSettings & AspectRatio::WIDESCREEN)
+        {
+            writer.Text("\"WIDESCREEN\"");
+        }
+        else if(image.videoSettings & AspectRatio::LETTERBOX)
+        {
+            writer.Text("\"LETTERBOX\"");
+        }
+        else
+        {
+            writer.Text("\"NORMAL\"");
+        }
+
+        writer.Key("audioModes");
+        writer.Char('[');
+        if(image.audioSettings & AudioMode::MONO)
+        {
+            writer.Text("\"MONO\"");
+        }
+        else if(image.audioSettings & AudioMode::SURROUND)
+        {
+            writer.Text("\"SURROUND\"");
+        }
+        else
+        {
+            writer.Text("\"STEREO\"");
+        }
+        if(image.audioSettings & AudioMode::AC3)
+        {
+            writer.Text(",\"AC3\"");
+        }
+        if(image.audioSettings & AudioMode::DTS)
+        {
+            writer.Text(",\"DTS\"");
+        }
+        writer.Char(']');
+
+        writer.Char('}');
+        return writer.Finish();
+    }
+
+    bool Serializer::FromJson(const char* json, unsigned int length, EepromData& outImage)
+    {
+        JsonReader reader(json, length);
+        unsigned char* bytes = (unsigned char*)&outImage;
+
+        memset(&outImage, 0, sizeof(outImage));
+
+        if(!reader.Expect('{'))
+        {
+            return false;
+        }
+        if(reader.Expect('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            char key[32];
+            if(!reader.Key(key, sizeof(key)) || !reader.Expect(':'))
+            {
+                return false;
+            }
+
+            const FieldInfo* field = NULL;
+            for(unsigned int i = 0; i < FIELD_COUNT; ++i)
+            {
+                if(strcmp(key, FIELDS[i].name) == 0)
+                {
+                    field = &FIELDS[i];
+                    break;
+                }
+            }
+
+            bool success;
+            if(!field)
+            {
+                success = reader.SkipValue();
+            }
+            else
+            {
+                unsigned char* value = bytes + field->offset;
+                switch(field->type)
+                {
+                    case FIELD_UINT:
+                    case FIELD_INT:
+                    {
+                        long long number;
+                        success = reader.Number(&number);
+                        if(success)
+                        {
+                            *(unsigned int*)value = (unsigned int)number;
+                        }
+                        break;
+                    }
+                    case FIELD_HEX:
+                    {
+                        success = reader.Hex(value, field->size);
+                        break;
+                    }
+                    case FIELD_STRING:
+                    {
+                        success = reader.String((char*)value, field->size);
+                        break;
+                    }
+                    case FIELD_MAC:
+                    {
+                        success = reader.Hex(value, field->size, ':');
+                        break;
+                    }
+                    default:
+                    {
+                        success = false;
+                        break;
+                    }
+                }
+            }
+
+            if(!success)
+            {
+                return false;
+            }
+        } while(reader.Expect(','));
+
+        return reader.Expect('}');
+    }
+
+    unsigned int Serializer::ToBinary(const EepromData& image, unsigned char* outBuffer, unsigned int bufferSize)
+    {
+        if(bufferSize < BINARY_RECORD_SIZE)
+        {
+            return 0;
+        }
+
+        outBuffer[0] = BINARY_MAGIC;
+        outBuffer[1] = BINARY_VERSION;
+        outBuffer[2] = (Checksum::IsFactoryValid(image) ? BINARY_FACTORY_VALID : 0) |
+                       (Checksum::IsUserValid(image) ? BINARY_USER_VALID : 0);
+        outBuffer[3] = 0;
+        memcpy(outBuffer + 4, &image, sizeof(EepromData));
+
+        return BINARY_RECORD_SIZE;
+    }
+
+    bool Serializer::FromBinary(const unsigned char* data, unsigned int length, EepromData& outImage)
+    {
+        if(length < BINARY_RECORD_SIZE || data[0] != BINARY_MAGIC || data[1] != BINARY_VERSION)
+        {
+            return false;
+        }
+
+        memcpy(&outImage, data + 4, sizeof(EepromData));
+        return true;
+    }
+
+    bool Serializer::GetBinaryChecksumStatus(const unsigned char* data, bool* outFactoryValid, bool* outUserValid)
+    {
+        if(data[0] != BINARY_MAGIC || data[1] != BINARY_VERSION)
+        {
+            return false;
+        }
+
+        *outFactoryValid = (data[2] & BINARY_FACTORY_VALID) != 0;
+        *outUserValid = (data[2] & BINARY_USER_VALID) != 0;
+        return true;
+    }
+} // namespace EEasyXB
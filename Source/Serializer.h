@@ -0,0 +1,102 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SERIALIZER_H
+#define SERIALIZER_H
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Converts whole eeprom images to and from JSON and a
+     * binary record. All functions write to caller provided
+     * buffers and never allocate.
+     * 
+     * The JSON object holds every field of EepromData under its
+     * member name, byte arrays as hex strings, followed by the
+     * checksum status and decoded video, audio and language
+     * settings. The decoded members are ignored when parsing.
+     * 
+     */
+    class Serializer
+    {
+    public:
+        /**
+         * @brief Write an image as a JSON object.
+         * 
+         * @param image Image to serialize.
+         * @param outBuffer Receives the null terminated JSON.
+         * @param bufferSize Size of outBuffer. MAX_JSON_SIZE is
+         * always enough.
+         * @return unsigned int Length of the JSON, not counting the
+         * terminator, or 0 if the buffer was too small.
+         */
+        static unsigned int ToJson(const EepromData& image, char* outBuffer, unsigned int bufferSize);
+
+        /**
+         * @brief Parse a JSON object written by ToJson(). Members
+         * that are missing are left zeroed.
+         * 
+         * @param json JSON text, does not need to be null terminated.
+         * @param length Length of the JSON text.
+         * @param outImage Overwritten with the parsed image.
+         * @return true If the operation was successful.
+         * @return false If the JSON is malformed.
+         */
+        static bool FromJson(const char* json, unsigned int length, EepromData& outImage);
+
+        /**
+         * @brief Write an image as a binary record of
+         * BINARY_RECORD_SIZE bytes.
+         * 
+         * @param image Image to serialize.
+         * @param outBuffer Receives the record.
+         * @param bufferSize Size of outBuffer.
+         * @return unsigned int Size of the record, or 0 if the
+         * buffer was too small.
+         */
+        static unsigned int ToBinary(const EepromData& image, unsigned char* outBuffer, unsigned int bufferSize);
+
+        /**
+         * @brief Read a binary record written by ToBinary().
+         * 
+         * @param data Start of the record.
+         * @param length Bytes available at data.
+         * @param outImage Overwritten with the image.
+         * @return true If the operation was successful.
+         * @return false If the record is truncated or invalid.
+         */
+        static bool FromBinary(const unsigned char* data, unsigned int length, EepromData& outImage);
+
+        /**
+         * @brief Read the checksum status stored in a binary record
+         * without decoding the image.
+         * 
+         * @param data Start of the record.
+         * @param outFactoryValid Receives the factory checksum status.
+         * @param outUserValid Receives the user checksum status.
+         * @return true If the record header is valid.
+         * @return false Otherwise.
+         */
+        static bool GetBinaryChecksumStatus(const unsigned char* data, bool* outFactoryValid, bool* outUserValid);
+
+        // Upper bound on the size of ToJson() output, terminator included
+        static const unsigned int MAX_JSON_SIZE = 2048;
+
+        // Header of magic, version and checksum flags, then the image
+        static const unsigned int BINARY_RECORD_SIZE = 4 + sizeof(EepromData);
+    };
+} // namespace EEasyXB
+
+#endif // SERIALIZER_H
@@ -0,0 +1,83 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SettingsPublisher.h"
+
+#include <string.h>
+
+namespace EEasyXB
+{
+    void SettingsPublisher::Initialize(PublishedSettings* block)
+    {
+        memset(&(block->data), 0, sizeof(block->data));
+        block->sequence.store(0, std::memory_order_relaxed);
+        block->magic = PublishedSettings::MAGIC;
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    bool SettingsPublisher::IsInitialized(const PublishedSettings* block)
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return (block->magic == PublishedSettings::MAGIC);
+    }
+
+    void SettingsPublisher::Publish(PublishedSettings* block, const EepromData& data)
+    {
+        unsigned int sequence = block->sequence.load(std::memory_order_relaxed);
+
+        block->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        memcpy(&(block->data), &data, sizeof(data));
+
+        block->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    unsigned int SettingsPublisher::GetGeneration(const PublishedSettings* block)
+    {
+        return (block->sequence.load(std::memory_order_acquire) & ~1u) / 2;
+    }
+
+    unsigned int SettingsPublisher::BeginRead(const PublishedSettings* block)
+    {
+        unsigned int sequence = block->sequence.load(std::memory_order_acquire);
+
+        // The writer only holds the sequence odd for one copy of
+        // the image, so spinning is cheaper than any wait.
+        while((sequence & 1) != 0)
+        {
+            sequence = block->sequence.load(std::memory_order_acquire);
+        }
+
+        return sequence;
+    }
+
+    bool SettingsPublisher::EndRead(const PublishedSettings* block, unsigned int token)
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return (block->sequence.load(std::memory_order_relaxed) == token);
+    }
+
+    unsigned int SettingsPublisher::Snapshot(const PublishedSettings* block, EepromData& outData)
+    {
+        unsigned int token;
+
+        do
+        {
+            token = BeginRead(block);
+            memcpy(&outData, &(block->data), sizeof(outData));
+        } while(!EndRead(block, token));
+
+        return token / 2;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,104 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SETTINGS_PUBLISHER_H
+#define SETTINGS_PUBLISHER_H
+
+#include "EepromData.h"
+#include "PublishedSettings.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Publishes eeprom images through a PublishedSettings
+     * block so readers can share one decoded copy.
+     * 
+     * The block is a sequence lock. A single writer bumps the
+     * sequence to an odd value, updates the image, then bumps it
+     * again. Readers read the image in place between BeginRead()
+     * and EndRead() and retry if a write overlapped, so they never
+     * take a lock or copy the image. The generation of a block is
+     * the number of images published to it. Waiting for a new
+     * image is host only, see EEasyXB::SettingsWatcher.
+     * 
+     */
+    class SettingsPublisher
+    {
+    public:
+        /**
+         * @brief Prepare a block for use. Call once, before any
+         * reader attaches.
+         * 
+         * @param block Block to prepare, for example one placed in
+         * a shared memory segment.
+         */
+        static void Initialize(PublishedSettings* block);
+
+        /**
+         * @brief Checks to see if a block has been initialized.
+         * 
+         * @param block Block to check.
+         * @return true If Initialize() was called on the block.
+         * @return false Otherwise.
+         */
+        static bool IsInitialized(const PublishedSettings* block);
+
+        /**
+         * @brief Publish a new image. Only one writer may publish
+         * to a block.
+         * 
+         * @param block Block to publish to.
+         * @param data Image to publish.
+         */
+        static void Publish(PublishedSettings* block, const EepromData& data);
+
+        /**
+         * @brief Get the number of images published to a block.
+         * 
+         * @param block Block to check.
+         * @return unsigned int Generation of the block. While a
+         * write is in progress this is the generation before it.
+         */
+        static unsigned int GetGeneration(const PublishedSettings* block);
+
+        /**
+         * @brief Start reading a block in place.
+         * 
+         * @param block Block to read.
+         * @return unsigned int Token to pass to EndRead().
+         */
+        static unsigned int BeginRead(const PublishedSettings* block);
+
+        /**
+         * @brief Finish reading a block in place.
+         * 
+         * @param block Block that was read.
+         * @param token Value returned by BeginRead().
+         * @return true If the values read are consistent.
+         * @return false If a write overlapped and the read must
+         * be repeated.
+         */
+        static bool EndRead(const PublishedSettings* block, unsigned int token);
+
+        /**
+         * @brief Copy a consistent image out of a block.
+         * 
+         * @param block Block to read.
+         * @param outData Receives the image.
+         * @return unsigned int Generation of the copied image.
+         */
+        static unsigned int Snapshot(const PublishedSettings* block, EepromData& outData);
+    };
+} // namespace EEasyXB
+
+#endif // SETTINGS_PUBLISHER_H
@@ -0,0 +1,39 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SettingsWatcher.h"
+#include "SettingsPublisher.h"
+
+#include <chrono>
+#include <thread>
+
+namespace EEasyXB
+{
+    bool SettingsWatcher::WaitForChange(const PublishedSettings* block, unsigned int knownGeneration,
+                                        unsigned int timeoutMilliseconds)
+    {
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+
+        while(SettingsPublisher::GetGeneration(block) == knownGeneration)
+        {
+            if(std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+} // namespace EEasyXB
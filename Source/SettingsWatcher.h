@@ -0,0 +1,44 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SETTINGS_WATCHER_H
+#define SETTINGS_WATCHER_H
+
+#include "PublishedSettings.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Lets host processes block until a new image is
+     * published to a PublishedSettings block. Host only, it
+     * sleeps between polls of the block's generation.
+     * 
+     */
+    class SettingsWatcher
+    {
+    public:
+        /**
+         * @brief Wait for a writer to publish a new image.
+         * 
+         * @param block Block to watch.
+         * @param knownGeneration Last generation seen by the caller.
+         * @param timeoutMilliseconds Longest time to wait.
+         * @return true If the generation has moved past knownGeneration.
+         * @return false If the wait timed out.
+         */
+        static bool WaitForChange(const PublishedSettings* block, unsigned int knownGeneration,
+                                  unsigned int timeoutMilliseconds);
+    };
+} // namespace EEasyXB
+
+#endif // SETTINGS_WATCHER_H
@@ -0,0 +1,266 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "TimeZone.h"
+
+namespace EEasyXB
+{
+    namespace
+    {
+        const int NO_YEAR = 0x7FFFFFFF;
+        const long long SECONDS_PER_DAY = 86400;
+        const unsigned int DAYS_IN_MONTH[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+        bool IsLeapYear(int year)
+        {
+            return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+        }
+    }
+
+    TimeZone::TimeZone()
+        : m_bias(0),
+          m_standardBias(0),
+          m_daylightBias(0)
+    {
+        m_standardStart = TimeZoneDate::FromRaw(0);
+        m_daylightStart = TimeZoneDate::FromRaw(0);
+
+        for(unsigned int i = 0; i < sizeof(m_standardName); ++i)
+        {
+            m_standardName[i] = 0;
+            m_daylightName[i] = 0;
+        }
+
+        ClearCache();
+    }
+
+    TimeZone::TimeZone(const EepromData& data)
+    {
+        Load(data);
+    }
+
+    void TimeZone::Load(const EepromData& data)
+    {
+        m_bias = (int)data.timeZoneBias;
+        m_standardBias = (int)data.timeZoneStandardBias;
+        m_daylightBias = (int)data.timeZoneDaylightBias;
+        m_standardStart = TimeZoneDate::FromRaw(data.timeZoneStandardStarts);
+        m_daylightStart = TimeZoneDate::FromRaw(data.timeZoneDaylightStarts);
+
+        for(unsigned int i = 0; i < sizeof(m_standardName); ++i)
+        {
+            m_standardName[i] = data.timeZoneStandardName[i];
+            m_daylightName[i] = data.timeZoneDaylightName[i];
+        }
+
+        ClearCache();
+    }
+
+    int TimeZone::GetBias() const
+    {
+        return m_bias;
+    }
+
+    int TimeZone::GetStandardBias() const
+    {
+        return m_standardBias;
+    }
+
+    int TimeZone::GetDaylightBias() const
+    {
+        return m_daylightBias;
+    }
+
+    TimeZoneDate TimeZone::GetStandardStart() const
+    {
+        return m_standardStart;
+    }
+
+    TimeZoneDate TimeZone::GetDaylightStart() const
+    {
+        return m_daylightStart;
+    }
+
+    void TimeZone::GetStandardName(char* outName) const
+    {
+        for(unsigned int i = 0; i < sizeof(m_standardName); ++i)
+        {
+            outName[i] = m_standardName[i];
+        }
+        outName[sizeof(m_standardName)] = 0;
+    }
+
+    void TimeZone::GetDaylightName(char* outName) const
+    {
+        for(unsigned int i = 0; i < sizeof(m_daylightName); ++i)
+        {
+            outName[i] = m_daylightName[i];
+        }
+        outName[sizeof(m_daylightName)] = 0;
+    }
+
+    bool TimeZone::HasDaylightSaving() const
+    {
+        return (m_standardStart.month != 0 && m_daylightStart.month != 0);
+    }
+
+    bool TimeZone::IsDaylightTime(long long localTime)
+    {
+        if(!HasDaylightSaving())
+        {
+            return false;
+        }
+
+        const Transitions& transitions = GetTransitions(YearOf(localTime));
+        return IsInDaylightRange(localTime,
+                                 transitions.daylightStartsLocal,
+                                 transitions.standardStartsLocal);
+    }
+
+    long long TimeZone::LocalToUtc(long long localTime)
+    {
+        int bias = m_bias + (IsDaylightTime(localTime) ? m_daylightBias : m_standardBias);
+        return localTime + ((long long)bias * 60);
+    }
+
+    long long TimeZone::UtcToLocal(long long utcTime)
+    {
+        bool isDaylight = false;
+
+        if(HasDaylightSaving())
+        {
+            const Transitions& transitions = GetTransitions(YearOf(utcTime));
+            isDaylight = IsInDaylightRange(utcTime,
+                                           transitions.daylightStartsUtc,
+                                           transitions.standardStartsUtc);
+        }
+
+        int bias = m_bias + (isDaylight ? m_daylightBias : m_standardBias);
+        return utcTime - ((long long)bias * 60);
+    }
+
+    void TimeZone::LocalToUtc(const long long* localTimes, long long* outUtcTimes, unsigned int count)
+    {
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            outUtcTimes[i] = LocalToUtc(localTimes[i]);
+        }
+    }
+
+    void TimeZone::UtcToLocal(const long long* utcTimes, long long* outLocalTimes, unsigned int count)
+    {
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            outLocalTimes[i] = UtcToLocal(utcTimes[i]);
+        }
+    }
+
+    void TimeZone::ClearCache()
+    {
+        for(unsigned int i = 0; i < TRANSITION_CACHE_SIZE; ++i)
+        {
+            m_cache[i].year = NO_YEAR;
+        }
+    }
+
+    const TimeZone::Transitions& TimeZone::GetTransitions(int year)
+    {
+        Transitions& transitions = m_cache[(unsigned int)year % TRANSITION_CACHE_SIZE];
+
+        if(transitions.year != year)
+        {
+            transitions.year = year;
+            transitions.daylightStartsLocal = ResolveTransition(year, m_daylightStart);
+            transitions.standardStartsLocal = ResolveTransition(year, m_standardStart);
+
+            // Daylight time starts on the standard time clock and
+            // standard time starts on the daylight time clock.
+            transitions.daylightStartsUtc = transitions.daylightStartsLocal +
+                                            ((long long)(m_bias + m_standardBias) * 60);
+            transitions.standardStartsUtc = transitions.standardStartsLocal +
+                                            ((long long)(m_bias + m_daylightBias) * 60);
+        }
+
+        return transitions;
+    }
+
+    long long TimeZone::ResolveTransition(int year, const TimeZoneDate& date) const
+    {
+        unsigned int month = (date.month >= 1 && date.month <= 12) ? date.month : 1;
+        unsigned int monthLength = DAYS_IN_MONTH[month - 1];
+        if(month == 2 && IsLeapYear(year))
+        {
+            monthLength++;
+        }
+
+        long long firstDay = DaysFromCivil(year, month, 1);
+
+        // 1970-01-01 was a Thursday
+        unsigned int firstDayOfWeek = (unsigned int)(((firstDay % 7) + 11) % 7);
+        unsigned int day = 1 + ((date.dayOfWeek % 7) + 7 - firstDayOfWeek) % 7;
+
+        if(date.week > 1)
+        {
+            day += (date.week - 1) * 7;
+        }
+
+        // Week 5 means the last occurrence in the month
+        while(day > monthLength)
+        {
+            day -= 7;
+        }
+
+        return ((firstDay + day - 1) * SECONDS_PER_DAY) + ((long long)date.hour * 3600);
+    }
+
+    bool TimeZone::IsInDaylightRange(long long time, long long daylightStarts, long long standardStarts) const
+    {
+        if(daylightStarts < standardStarts)
+        {
+            return (time >= daylightStarts && time < standardStarts);
+        }
+
+        // Southern hemisphere, daylight time spans the new year
+        return (time >= daylightStarts || time < standardStarts);
+    }
+
+    int TimeZone::YearOf(long long time)
+    {
+        long long days = time / SECONDS_PER_DAY;
+        if((time % SECONDS_PER_DAY) < 0)
+        {
+            days--;
+        }
+
+        // Civil from days, see http://howardhinnant.github.io/date_algorithms.html
+        days += 719468;
+        long long era = (days >= 0 ? days : days - 146096) / 146097;
+        unsigned int dayOfEra = (unsigned int)(days - era * 146097);
+        unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        unsigned int monthPrime = (5 * dayOfYear + 2) / 153;
+
+        return (int)(yearOfEra + era * 400) + (monthPrime >= 10 ? 1 : 0);
+    }
+
+    long long TimeZone::DaysFromCivil(int year, unsigned int month, unsigned int day)
+    {
+        year -= (month <= 2) ? 1 : 0;
+        long long era = (year >= 0 ? year : year - 399) / 400;
+        unsigned int yearOfEra = (unsigned int)(year - era * 400);
+        unsigned int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+        return era * 146097 + (long long)dayOfEra - 719468;
+    }
+} // namespace EEasyXB
@@ -0,0 +1,202 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef TIME_ZONE_H
+#define TIME_ZONE_H
+
+#include "EepromData.h"
+#include "TimeZoneDate.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Decoder for the time zone portion of the user
+     * section of the eeprom. Converts between local time and
+     * UTC using the bias and daylight saving rules stored in
+     * the eeprom.
+     *
+     * Times are expressed in seconds since 1970-01-01 00:00:00.
+     * Daylight saving transitions are computed once per year and
+     * cached, so converting runs of timestamps from the same
+     * year costs a table lookup per call.
+     *
+     */
+    class TimeZone
+    {
+    public:
+        /**
+         * @brief Construct a time zone with no bias and no
+         * daylight saving.
+         *
+         */
+        TimeZone();
+
+        /**
+         * @brief Construct a time zone from the user section of
+         * an eeprom image.
+         *
+         * @param data Eeprom image to decode.
+         */
+        explicit TimeZone(const EepromData& data);
+
+        /**
+         * @brief Reload the time zone from an eeprom image,
+         * discarding any cached transitions.
+         *
+         * @param data Eeprom image to decode.
+         */
+        void Load(const EepromData& data);
+
+        /**
+         * @brief Get the base bias of the time zone.
+         *
+         * @return int Minutes to add to local time to get UTC.
+         */
+        int GetBias() const;
+
+        /**
+         * @brief Get the bias applied on top of the base bias
+         * while standard time is in effect.
+         *
+         * @return int Bias in minutes.
+         */
+        int GetStandardBias() const;
+
+        /**
+         * @brief Get the bias applied on top of the base bias
+         * while daylight saving time is in effect.
+         *
+         * @return int Bias in minutes.
+         */
+        int GetDaylightBias() const;
+
+        /**
+         * @brief Get the rule that starts standard time.
+         *
+         * @return TimeZoneDate Decoded transition rule.
+         */
+        TimeZoneDate GetStandardStart() const;
+
+        /**
+         * @brief Get the rule that starts daylight saving time.
+         *
+         * @return TimeZoneDate Decoded transition rule.
+         */
+        TimeZoneDate GetDaylightStart() const;
+
+        /**
+         * @brief Copy the abbreviated name of standard time.
+         *
+         * @param outName Buffer of at least 5 characters. Receives
+         * a null terminated copy of the name.
+         */
+        void GetStandardName(char* outName) const;
+
+        /**
+         * @brief Copy the abbreviated name of daylight saving time.
+         *
+         * @param outName Buffer of at least 5 characters. Receives
+         * a null terminated copy of the name.
+         */
+        void GetDaylightName(char* outName) const;
+
+        /**
+         * @brief Checks to see if the time zone observes daylight
+         * saving time.
+         *
+         * @return true If both transition rules are set.
+         * @return false Otherwise.
+         */
+        bool HasDaylightSaving() const;
+
+        /**
+         * @brief Checks to see if daylight saving time is in
+         * effect at a given local time.
+         *
+         * @param localTime Local time in seconds since 1970.
+         * @return true If daylight saving time is in effect.
+         * @return false Otherwise.
+         */
+        bool IsDaylightTime(long long localTime);
+
+        /**
+         * @brief Convert a local time to UTC.
+         *
+         * @param localTime Local time in seconds since 1970.
+         * @return long long UTC time in seconds since 1970.
+         */
+        long long LocalToUtc(long long localTime);
+
+        /**
+         * @brief Convert a UTC time to local time.
+         *
+         * @param utcTime UTC time in seconds since 1970.
+         * @return long long Local time in seconds since 1970.
+         */
+        long long UtcToLocal(long long utcTime);
+
+        /**
+         * @brief Convert a batch of local times to UTC.
+         *
+         * @param localTimes Local times in seconds since 1970.
+         * @param outUtcTimes Receives the converted times. May be
+         * the same buffer as localTimes.
+         * @param count Number of times to convert.
+         */
+        void LocalToUtc(const long long* localTimes, long long* outUtcTimes, unsigned int count);
+
+        /**
+         * @brief Convert a batch of UTC times to local time.
+         *
+         * @param utcTimes UTC times in seconds since 1970.
+         * @param outLocalTimes Receives the converted times. May be
+         * the same buffer as utcTimes.
+         * @param count Number of times to convert.
+         */
+        void UtcToLocal(const long long* utcTimes, long long* outLocalTimes, unsigned int count);
+
+    private:
+        // Transition instants for one year, both in local wall
+        // clock time and in UTC.
+        struct Transitions
+        {
+            int year;
+            long long daylightStartsLocal;
+            long long standardStartsLocal;
+            long long daylightStartsUtc;
+            long long standardStartsUtc;
+        };
+
+        // Direct mapped by year, enough to cover a decade of logs
+        static const unsigned int TRANSITION_CACHE_SIZE = 16;
+
+        int m_bias;
+        int m_standardBias;
+        int m_daylightBias;
+        TimeZoneDate m_standardStart;
+        TimeZoneDate m_daylightStart;
+        char m_standardName[4];
+        char m_daylightName[4];
+        Transitions m_cache[TRANSITION_CACHE_SIZE];
+
+        void ClearCache();
+        const Transitions& GetTransitions(int year);
+        long long ResolveTransition(int year, const TimeZoneDate& date) const;
+        bool IsInDaylightRange(long long time, long long daylightStarts, long long standardStarts) const;
+
+        static int YearOf(long long time);
+        static long long DaysFromCivil(int year, unsigned int month, unsigned int day);
+    };
+} // namespace EEasyXB
+
+#endif // TIME_ZONE_H
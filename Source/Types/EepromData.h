@@ -49,12 +49,12 @@ namespace EEasyXB
         unsigned char padding80[8];
         unsigned int timeZoneStandardBias;
         unsigned int timeZoneDaylightBias;
-        unsigned int language;					// TODO: enum
+        unsigned int language;					// EEasyXB::Language
         unsigned int videoSettings;			// TODO: enum
         unsigned int audioSettings;			// TODO: enum
-        unsigned int parentalControlGame;		// TODO: enum
-        unsigned int parentalControlPasscode;	// TODO: enum
-        unsigned int parentalControlMovie;	// TODO: enum
+        unsigned int parentalControlGame;		// EEasyXB::GameRating
+        unsigned int parentalControlPasscode;	// 4 EEasyXB::PasscodeButton nibbles
+        unsigned int parentalControlMovie;	// EEasyXB::MovieRating
         unsigned int liveIp;
         unsigned int liveDns;
         unsigned int liveGateway;
@@ -62,7 +62,7 @@ namespace EEasyXB
         unsigned int unknownB8;
         unsigned int dvdZone;					// TODO: enum
 
-        // history section?
+        // history section, see EEasyXB::History
         unsigned char history[64];
     };
 } // namespace EEasyXB
@@ -0,0 +1,70 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef EEPROM_PACK_HEADER_H
+#define EEPROM_PACK_HEADER_H
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Header at the start of a pack file of eeprom images.
+     * 
+     * A pack file is laid out as follows:
+     *  - EepromPackHeader
+     *  - The base image, an EepromData every record is relative to
+     *  - Blocks of up to recordsPerBlock records each
+     *  - The block index, one EepromPackBlock per block
+     * 
+     * Each record is the image XORed with the base image, stored
+     * as a series of runs. A run is a varint count of unchanged
+     * bytes to skip, a varint count of literal bytes, then the
+     * literal bytes. A record ends once its runs cover the whole
+     * image.
+     * 
+     * Only bytes that differ from the base cost space, so the
+     * ratio depends on the archive. Fields that are random per
+     * unit, such as the keys, hashes and checksums, do not repeat
+     * between images and take roughly 60 bytes of every record,
+     * which limits a typical archive to about 2 to 3 times smaller
+     * than the raw images.
+     * 
+     */
+    struct EepromPackHeader
+    {
+        unsigned int magic;
+        unsigned int version;
+        unsigned int recordCount;
+        unsigned int recordsPerBlock;
+        unsigned int blockCount;
+        unsigned int indexOffsetLow;    // byte offset of the block index
+        unsigned int indexOffsetHigh;
+        unsigned int reserved;
+
+        static const unsigned int MAGIC = 0x50425845;   // "EXBP"
+        static const unsigned int VERSION = 1;
+    };
+
+    /**
+     * @brief Entry of the block index of a pack file.
+     * 
+     */
+    struct EepromPackBlock
+    {
+        unsigned int offsetLow;     // byte offset of the first record
+        unsigned int offsetHigh;
+    };
+} // namespace EEasyXB
+
+#endif // EEPROM_PACK_HEADER_H
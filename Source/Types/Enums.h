@@ -53,6 +53,73 @@ namespace EEasyXB
         AC3= 0x00010000,
         DTS = 0x00020000
     };
+
+    /**
+     * @brief User selectable dashboard language.
+     * 
+     */
+    enum Language
+    {
+        LANGUAGE_NOT_SET = 0,
+        LANGUAGE_ENGLISH = 1,
+        LANGUAGE_JAPANESE = 2,
+        LANGUAGE_GERMAN = 3,
+        LANGUAGE_FRENCH = 4,
+        LANGUAGE_SPANISH = 5,
+        LANGUAGE_ITALIAN = 6,
+        LANGUAGE_KOREAN = 7,
+        LANGUAGE_CHINESE = 8,
+        LANGUAGE_PORTUGUESE = 9
+    };
+
+    /**
+     * @brief Most mature game rating allowed by parental
+     * controls. Higher values are more restrictive.
+     * 
+     */
+    enum GameRating
+    {
+        GAME_RATING_ALL = 0,
+        GAME_RATING_ADULTS_ONLY = 1,
+        GAME_RATING_MATURE = 2,
+        GAME_RATING_TEEN = 3,
+        GAME_RATING_EVERYONE = 4,
+        GAME_RATING_KIDS_TO_ADULTS = 5,
+        GAME_RATING_EARLY_CHILDHOOD = 6
+    };
+
+    /**
+     * @brief Most mature movie rating allowed by parental
+     * controls. Higher values are more restrictive.
+     * 
+     */
+    enum MovieRating
+    {
+        MOVIE_RATING_ALL = 0,
+        MOVIE_RATING_NC17 = 1,
+        MOVIE_RATING_R = 2,
+        MOVIE_RATING_PG13 = 3,
+        MOVIE_RATING_PG = 4,
+        MOVIE_RATING_G = 5
+    };
+
+    /**
+     * @brief Controller buttons that make up a parental
+     * control passcode.
+     * 
+     */
+    enum PasscodeButton
+    {
+        PASSCODE_NONE = 0,
+        PASSCODE_DPAD_UP = 1,
+        PASSCODE_DPAD_DOWN = 2,
+        PASSCODE_DPAD_LEFT = 3,
+        PASSCODE_DPAD_RIGHT = 4,
+        PASSCODE_X = 5,
+        PASSCODE_Y = 6,
+        PASSCODE_LEFT_TRIGGER = 7,
+        PASSCODE_RIGHT_TRIGGER = 8
+    };
 } // namespace EEasyXB
 
 #endif // ENUMS_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef HISTORY_ENTRY_H
+#define HISTORY_ENTRY_H
+
+namespace EEasyXB
+{
+    /**
+     * @brief One entry of the history section of the eeprom,
+     * stored as a single 32 bit word with the event code in
+     * the low 16 bits.
+     * 
+     */
+    struct HistoryEntry
+    {
+        unsigned short eventCode;   // caller defined, 0 is reserved for empty slots
+        unsigned short value;       // caller defined data for the event
+
+        /**
+         * @brief Decode a raw history word.
+         * 
+         * @param raw Word as stored in the eeprom.
+         * @return HistoryEntry Decoded entry.
+         */
+        static HistoryEntry FromRaw(unsigned int raw)
+        {
+            HistoryEntry entry;
+            entry.eventCode = (unsigned short)(raw & 0xFFFF);
+            entry.value = (unsigned short)(raw >> 16);
+            return entry;
+        }
+
+        /**
+         * @brief Encode this entry as it is stored in the eeprom.
+         * 
+         * @return unsigned int Raw history word.
+         */
+        unsigned int ToRaw() const
+        {
+            return (unsigned int)eventCode | ((unsigned int)value << 16);
+        }
+    };
+} // namespace EEasyXB
+
+#endif // HISTORY_ENTRY_H
@@ -0,0 +1,71 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef IP_ADDRESS_H
+#define IP_ADDRESS_H
+
+namespace EEasyXB
+{
+    /**
+     * @brief Helpers for the liveIp, liveDns, liveGateway and
+     * liveSubnet fields of the eeprom. Addresses are stored in
+     * network byte order, so the first octet of the address is
+     * the least significant byte of the stored value.
+     * 
+     */
+    struct IpAddress
+    {
+        /**
+         * @brief Build an address in the eeprom encoding.
+         * 
+         * @return unsigned int Address for a.b.c.d
+         */
+        static unsigned int Make(unsigned char a, unsigned char b, unsigned char c, unsigned char d)
+        {
+            return (unsigned int)a |
+                   ((unsigned int)b << 8) |
+                   ((unsigned int)c << 16) |
+                   ((unsigned int)d << 24);
+        }
+
+        /**
+         * @brief Get one octet of an address.
+         * 
+         * @param address Address in the eeprom encoding.
+         * @param index 0 for the first octet, 3 for the last.
+         * @return unsigned char Value of the octet.
+         */
+        static unsigned char GetOctet(unsigned int address, unsigned int index)
+        {
+            return (unsigned char)((address >> (index * 8)) & 0xFF);
+        }
+
+        /**
+         * @brief Convert between the eeprom encoding and a value
+         * where the first octet is the most significant byte,
+         * which can be incremented and compared numerically.
+         * 
+         * @param address Address in either encoding.
+         * @return unsigned int Address in the other encoding.
+         */
+        static unsigned int SwapOrder(unsigned int address)
+        {
+            return ((address & 0x000000FF) << 24) |
+                   ((address & 0x0000FF00) << 8) |
+                   ((address & 0x00FF0000) >> 8) |
+                   ((address & 0xFF000000) >> 24);
+        }
+    };
+} // namespace EEasyXB
+
+#endif // IP_ADDRESS_H
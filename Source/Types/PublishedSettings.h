@@ -0,0 +1,39 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef PUBLISHED_SETTINGS_H
+#define PUBLISHED_SETTINGS_H
+
+#include <atomic>
+
+#include "EepromData.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Block holding the most recently committed eeprom
+     * image for other readers. Contains no pointers, so it can be
+     * placed in memory shared between processes.
+     * 
+     */
+    struct PublishedSettings
+    {
+        std::atomic<unsigned int> sequence;    // odd while a writer is updating data
+        unsigned int magic;
+        EepromData data;
+
+        static const unsigned int MAGIC = 0x53505845;   // "EXPS"
+    };
+} // namespace EEasyXB
+
+#endif // PUBLISHED_SETTINGS_H
@@ -0,0 +1,64 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef TIME_ZONE_DATE_H
+#define TIME_ZONE_DATE_H
+
+namespace EEasyXB
+{
+    /**
+     * @brief Decoded form of the timeZoneStandardStarts and
+     * timeZoneDaylightStarts fields of the eeprom. Each field
+     * packs a recurring rule, one byte per member, with the
+     * month in the least significant byte.
+     *
+     */
+    struct TimeZoneDate
+    {
+        unsigned char month;        // 1 - 12, 0 if the rule is unused
+        unsigned char week;         // 1 - 4, 5 for the last week of the month
+        unsigned char dayOfWeek;    // 0 (Sunday) - 6 (Saturday)
+        unsigned char hour;         // local hour the transition happens at
+
+        /**
+         * @brief Decode a raw eeprom value.
+         *
+         * @param raw Value as stored in the eeprom.
+         * @return TimeZoneDate Decoded rule.
+         */
+        static TimeZoneDate FromRaw(unsigned int raw)
+        {
+            TimeZoneDate date;
+            date.month = (unsigned char)(raw & 0xFF);
+            date.week = (unsigned char)((raw >> 8) & 0xFF);
+            date.dayOfWeek = (unsigned char)((raw >> 16) & 0xFF);
+            date.hour = (unsigned char)((raw >> 24) & 0xFF);
+            return date;
+        }
+
+        /**
+         * @brief Encode this rule as it is stored in the eeprom.
+         *
+         * @return unsigned int Raw eeprom value.
+         */
+        unsigned int ToRaw() const
+        {
+            return (unsigned int)month |
+                   ((unsigned int)week << 8) |
+                   ((unsigned int)dayOfWeek << 16) |
+                   ((unsigned int)hour << 24);
+        }
+    };
+} // namespace EEasyXB
+
+#endif // TIME_ZONE_DATE_H
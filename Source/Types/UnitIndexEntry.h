@@ -0,0 +1,47 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef UNIT_INDEX_ENTRY_H
+#define UNIT_INDEX_ENTRY_H
+
+namespace EEasyXB
+{
+    /**
+     * @brief Location of one eeprom image inside an archive, keyed
+     * by the serial number and MAC address of the unit it came
+     * from. Only 32 bit members are used so the layout is the
+     * same on the Xbox and on 64 bit hosts.
+     * 
+     */
+    struct UnitIndexEntry
+    {
+        char serial[12];
+        unsigned char macAddress[6];
+        unsigned short reserved;
+        unsigned int archiveId;     // caller defined archive identifier
+        unsigned int offsetLow;     // byte offset of the image in the archive
+        unsigned int offsetHigh;
+
+        /**
+         * @brief Get the byte offset of the image in its archive.
+         * 
+         * @return unsigned long long Offset in bytes.
+         */
+        unsigned long long GetOffset() const
+        {
+            return ((unsigned long long)offsetHigh << 32) | offsetLow;
+        }
+    };
+} // namespace EEasyXB
+
+#endif // UNIT_INDEX_ENTRY_H
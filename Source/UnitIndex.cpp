@@ -0,0 +1,388 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitIndex.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+namespace EEasyXB
+{
+    namespace
+    {
+        bool SerialLess(const UnitIndexEntry& left, const UnitIndexEntry& right)
+        {
+            return memcmp(left.serial, right.serial, sizeof(left.serial)) < 0;
+        }
+
+        struct MacLess
+        {
+            const UnitIndexEntry* entries;
+
+            bool operator()(unsigned int left, unsigned int right) const
+            {
+                return memcmp(entries[left].macAddress, entries[right].macAddress,
+                              sizeof(entries[left].macAddress)) < 0;
+            }
+        };
+
+        // Smallest pending table that is merged, so small indexes
+        // do not merge on every few adds
+        const unsigned int MIN_MERGE_THRESHOLD = 64;
+
+        // Checks a pair of arrays read from a file. Positions must
+        // be in range and both arrays sorted, or the binary searches
+        // would silently miss entries.
+        bool IsValidIndex(const UnitIndexEntry* entries, const unsigned int* macOrder, unsigned int count)
+        {
+            for(unsigned int i = 0; i < count; ++i)
+            {
+                if(macOrder[i] >= count)
+                {
+                    return false;
+                }
+            }
+
+            MacLess macLess = { entries };
+            for(unsigned int i = 1; i < count; ++i)
+            {
+                if(SerialLess(entries[i], entries[i - 1]) || macLess(macOrder[i], macOrder[i - 1]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Appends the matches of one pair of sorted arrays to
+        // outEntries, counting those that do not fit.
+        unsigned int CollectBySerial(const UnitIndexEntry* entries, unsigned int count, const UnitIndexEntry& key,
+                                     const UnitIndexEntry** outEntries, unsigned int maxEntries,
+                                     unsigned int matches)
+        {
+            std::pair<const UnitIndexEntry*, const UnitIndexEntry*> range =
+                std::equal_range(entries, entries + count, key, SerialLess);
+
+            for(const UnitIndexEntry* entry = range.first; entry != range.second; ++entry)
+            {
+                if(matches < maxEntries)
+                {
+                    outEntries[matches] = entry;
+                }
+                matches++;
+            }
+
+            return matches;
+        }
+
+        unsigned int CollectByMac(const UnitIndexEntry* entries, const unsigned int* macOrder, unsigned int count,
+                                  const unsigned char* macAddress, const UnitIndexEntry** outEntries,
+                                  unsigned int maxEntries, unsigned int matches)
+        {
+            // Binary search for the first position whose entry is not
+            // less than the key.
+            unsigned int low = 0, high = count;
+            while(low < high)
+            {
+                unsigned int middle = low + (high - low) / 2;
+                if(memcmp(entries[macOrder[middle]].macAddress, macAddress, 6) < 0)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+
+            for(unsigned int i = low; i < count; ++i)
+            {
+                const UnitIndexEntry* entry = &entries[macOrder[i]];
+                if(memcmp(entry->macAddress, macAddress, 6) != 0)
+                {
+                    break;
+                }
+
+                if(matches < maxEntries)
+                {
+                    outEntries[matches] = entry;
+                }
+                matches++;
+            }
+
+            return matches;
+        }
+    }
+
+    UnitIndex::UnitIndex()
+        : m_searchEntries(NULL),
+          m_searchMacOrder(NULL),
+          m_searchCount(0),
+          m_isAttached(false)
+    {
+
+    }
+
+    void UnitIndex::Add(const EepromData& image, unsigned int archiveId, unsigned long long offset)
+    {
+        UnitIndexEntry entry;
+        memcpy(entry.serial, image.serial, sizeof(entry.serial));
+        memcpy(entry.macAddress, image.macAddress, sizeof(entry.macAddress));
+        entry.reserved = 0;
+        entry.archiveId = archiveId;
+        entry.offsetLow = (unsigned int)offset;
+        entry.offsetHigh = (unsigned int)(offset >> 32);
+
+        // Insert into the side table, keeping both of its orders
+        unsigned int position = (unsigned int)(std::upper_bound(m_pending.begin(), m_pending.end(), entry, SerialLess) -
+                                               m_pending.begin());
+        m_pending.insert(m_pending.begin() + position, entry);
+
+        for(unsigned int i = 0; i < m_pendingMacOrder.size(); ++i)
+        {
+            if(m_pendingMacOrder[i] >= position)
+            {
+                m_pendingMacOrder[i]++;
+            }
+        }
+
+        MacLess macLess = { m_pending.data() };
+        m_pendingMacOrder.insert(std::upper_bound(m_pendingMacOrder.begin(), m_pendingMacOrder.end(),
+                                                  position, macLess),
+                                 position);
+
+        // Inserting costs the table size and merging costs the
+        // index size, so the table is kept near four times the
+        // square root of the index, which measured best
+        unsigned int threshold = MIN_MERGE_THRESHOLD;
+        while((unsigned long long)threshold * threshold < 16ULL * m_searchCount)
+        {
+            threshold *= 2;
+        }
+
+        if(m_pending.size() > threshold)
+        {
+            Merge();
+        }
+    }
+
+    unsigned int UnitIndex::GetCount() const
+    {
+        return m_searchCount + (unsigned int)m_pending.size();
+    }
+
+    unsigned int UnitIndex::FindBySerial(const char* serial, const UnitIndexEntry** outEntries,
+                                         unsigned int maxEntries) const
+    {
+        UnitIndexEntry key;
+        memcpy(key.serial, serial, sizeof(key.serial));
+
+        unsigned int matches = CollectBySerial(m_searchEntries, m_searchCount, key, outEntries, maxEntries, 0);
+        return CollectBySerial(m_pending.data(), (unsigned int)m_pending.size(), key, outEntries, maxEntries,
+                               matches);
+    }
+
+    unsigned int UnitIndex::FindByMac(const unsigned char* macAddress, const UnitIndexEntry** outEntries,
+                                      unsigned int maxEntries) const
+    {
+        unsigned int matches = CollectByMac(m_searchEntries, m_searchMacOrder, m_searchCount, macAddress,
+                                            outEntries, maxEntries, 0);
+        return CollectByMac(m_pending.data(), m_pendingMacOrder.data(), (unsigned int)m_pending.size(),
+                            macAddress, outEntries, maxEntries, matches);
+    }
+
+    bool UnitIndex::Save(const char* path)
+    {
+        Merge();
+
+        FILE* file = fopen(path, "wb");
+        if(!file)
+        {
+            return false;
+        }
+
+        Header header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.count = m_searchCount;
+        header.reserved = 0;
+
+        bool success = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                       (fwrite(m_searchEntries, sizeof(UnitIndexEntry), m_searchCount, file) == m_searchCount) &&
+                       (fwrite(m_searchMacOrder, sizeof(unsigned int), m_searchCount, file) == m_searchCount);
+
+        return (fclose(file) == 0) && success;
+    }
+
+    bool UnitIndex::Load(const char* path)
+    {
+        FILE* file = fopen(path, "rb");
+        if(!file)
+        {
+            return false;
+        }
+
+        // The count is checked against the file size before it is
+        // used to size anything.
+        long fileSize = -1;
+        if(fseek(file, 0, SEEK_END) == 0)
+        {
+            fileSize = ftell(file);
+        }
+
+        Header header;
+        bool success = fileSize >= 0 &&
+                       fseek(file, 0, SEEK_SET) == 0 &&
+                       (fread(&header, sizeof(header), 1, file) == 1) &&
+                       header.magic == MAGIC &&
+                       header.version == VERSION &&
+                       (unsigned long long)fileSize >= sizeof(Header) +
+                           (unsigned long long)header.count * (sizeof(UnitIndexEntry) + sizeof(unsigned int));
+
+        if(success)
+        {
+            m_isAttached = false;
+            m_pending.clear();
+            m_pendingMacOrder.clear();
+            m_entries.resize(header.count);
+            m_macOrder.resize(header.count);
+
+            success = (fread(m_entries.data(), sizeof(UnitIndexEntry), header.count, file) == header.count) &&
+                      (fread(m_macOrder.data(), sizeof(unsigned int), header.count, file) == header.count) &&
+                      IsValidIndex(m_entries.data(), m_macOrder.data(), header.count);
+
+            if(!success)
+            {
+                m_entries.clear();
+                m_macOrder.clear();
+            }
+
+            UseOwnedArrays();
+        }
+
+        fclose(file);
+        return success;
+    }
+
+    bool UnitIndex::Attach(const void* data, unsigned long long size)
+    {
+        if(size < sizeof(Header))
+        {
+            return false;
+        }
+
+        const Header* header = (const Header*)data;
+        unsigned long long expectedSize = sizeof(Header) +
+            (unsigned long long)header->count * (sizeof(UnitIndexEntry) + sizeof(unsigned int));
+
+        if(header->magic != MAGIC || header->version != VERSION || size < expectedSize)
+        {
+            return false;
+        }
+
+        const UnitIndexEntry* entries = (const UnitIndexEntry*)(header + 1);
+        const unsigned int* macOrder = (const unsigned int*)(entries + header->count);
+        if(!IsValidIndex(entries, macOrder, header->count))
+        {
+            return false;
+        }
+
+        m_entries.clear();
+        m_macOrder.clear();
+        m_pending.clear();
+        m_pendingMacOrder.clear();
+
+        m_searchEntries = entries;
+        m_searchMacOrder = macOrder;
+        m_searchCount = header->count;
+        m_isAttached = true;
+
+        return true;
+    }
+
+    void UnitIndex::Merge()
+    {
+        if(m_pending.empty())
+        {
+            return;
+        }
+
+        Detach();
+
+        // Merge by serial, recording where every entry lands so
+        // both MAC orders only need remapping, not re-sorting.
+        std::vector<UnitIndexEntry> entries;
+        entries.reserve(m_entries.size() + m_pending.size());
+        std::vector<unsigned int> newPositions(m_entries.size());
+        std::vector<unsigned int> newPendingPositions(m_pending.size());
+
+        size_t existing = 0, added = 0;
+        while(existing < m_entries.size() || added < m_pending.size())
+        {
+            if(added == m_pending.size() ||
+               (existing < m_entries.size() && !SerialLess(m_pending[added], m_entries[existing])))
+            {
+                newPositions[existing] = (unsigned int)entries.size();
+                entries.push_back(m_entries[existing++]);
+            }
+            else
+            {
+                newPendingPositions[added] = (unsigned int)entries.size();
+                entries.push_back(m_pending[added++]);
+            }
+        }
+
+        for(unsigned int i = 0; i < m_macOrder.size(); ++i)
+        {
+            m_macOrder[i] = newPositions[m_macOrder[i]];
+        }
+
+        for(unsigned int i = 0; i < m_pendingMacOrder.size(); ++i)
+        {
+            m_pendingMacOrder[i] = newPendingPositions[m_pendingMacOrder[i]];
+        }
+
+        MacLess macLess = { entries.data() };
+        std::vector<unsigned int> macOrder(entries.size());
+        std::merge(m_macOrder.begin(), m_macOrder.end(),
+                   m_pendingMacOrder.begin(), m_pendingMacOrder.end(),
+                   macOrder.begin(), macLess);
+
+        m_entries.swap(entries);
+        m_macOrder.swap(macOrder);
+        m_pending.clear();
+        m_pendingMacOrder.clear();
+
+        UseOwnedArrays();
+    }
+
+    void UnitIndex::Detach()
+    {
+        if(m_isAttached)
+        {
+            m_entries.assign(m_searchEntries, m_searchEntries + m_searchCount);
+            m_macOrder.assign(m_searchMacOrder, m_searchMacOrder + m_searchCount);
+            m_isAttached = false;
+            UseOwnedArrays();
+        }
+    }
+
+    void UnitIndex::UseOwnedArrays()
+    {
+        m_searchEntries = m_entries.data();
+        m_searchMacOrder = m_macOrder.data();
+        m_searchCount = (unsigned int)m_entries.size();
+    }
+} // namespace EEasyXB
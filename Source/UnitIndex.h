@@ -0,0 +1,159 @@
+/*
+Copyright 2021 Chase Cobb
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef UNIT_INDEX_H
+#define UNIT_INDEX_H
+
+#include <vector>
+
+#include "EepromData.h"
+#include "UnitIndexEntry.h"
+
+namespace EEasyXB
+{
+    /**
+     * @brief Index from serial number and MAC address to the
+     * location of eeprom images in one or more archives.
+     * 
+     * Entries are kept in an array sorted by serial number, plus
+     * a second array of entry positions sorted by MAC address, so
+     * both lookups are a binary search. The saved file is a header
+     * followed by those two arrays exactly as they are held in
+     * memory, which lets a mapped file be searched in place with
+     * Attach().
+     * 
+     * Added entries go to a small side table with the same two
+     * sorted arrays, searched alongside the main ones. The side
+     * table is merged into the main arrays once it grows past about
+     * four times the square root of the index size, which balances
+     * the cost of inserting into it against the cost of merging, so
+     * ingest and lookups can be interleaved on a large index.
+     * 
+     */
+    class UnitIndex
+    {
+    public:
+        UnitIndex();
+
+        /**
+         * @brief Add the location of an image to the index. The
+         * entry can be found straight away.
+         * 
+         * @param image Image being ingested.
+         * @param archiveId Caller defined id of the archive.
+         * @param offset Byte offset of the image in the archive.
+         */
+        void Add(const EepromData& image, unsigned int archiveId, unsigned long long offset);
+
+        /**
+         * @brief Get the number of entries in the index.
+         * 
+         * @return unsigned int Number of entries, including any
+         * that have not been merged yet.
+         */
+        unsigned int GetCount() const;
+
+        /**
+         * @brief Find every image of the unit with a given serial.
+         * 
+         * @param serial 12 character serial number.
+         * @param outEntries Receives pointers to the matches. They
+         * stay valid until the index is next modified.
+         * @param maxEntries Size of outEntries.
+         * @return unsigned int Total number of matches, which may
+         * exceed maxEntries.
+         */
+        unsigned int FindBySerial(const char* serial, const UnitIndexEntry** outEntries,
+                                  unsigned int maxEntries) const;
+
+        /**
+         * @brief Find every image of the unit with a given MAC
+         * address.
+         * 
+         * @param macAddress 6 byte MAC address.
+         * @param outEntries Receives pointers to the matches. They
+         * stay valid until the index is next modified.
+         * @param maxEntries Size of outEntries.
+         * @return unsigned int Total number of matches, which may
+         * exceed maxEntries.
+         */
+        unsigned int FindByMac(const unsigned char* macAddress, const UnitIndexEntry** outEntries,
+                               unsigned int maxEntries) const;
+
+        /**
+         * @brief Write the index to a file.
+         * 
+         * @param path Path of the file to create.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Save(const char* path);
+
+        /**
+         * @brief Replace the contents of the index with a file
+         * written by Save().
+         * 
+         * @param path Path of the file to read.
+         * @return true If the operation was successful.
+         * @return false Otherwise.
+         */
+        bool Load(const char* path);
+
+        /**
+         * @brief Search the contents of a file written by Save()
+         * that is already in memory, such as a mapped file,
+         * without copying it. The file is checked once here,
+         * including its sort order. The memory must stay valid
+         * until the index is destroyed, replaced, or takes a
+         * private copy, which happens when Add() merges the side
+         * table or on Save() after an Add().
+         * 
+         * @param data Start of the file contents. Must be 4 byte
+         * aligned.
+         * @param size Size of the file contents in bytes.
+         * @return true If the data is a valid index.
+         * @return false Otherwise.
+         */
+        bool Attach(const void* data, unsigned long long size);
+
+    private:
+        struct Header
+        {
+            unsigned int magic;
+            unsigned int version;
+            unsigned int count;
+            unsigned int reserved;
+        };
+
+        static const unsigned int MAGIC = 0x49425845;   // "EXBI"
+        static const unsigned int VERSION = 1;
+
+        std::vector<UnitIndexEntry> m_entries;      // sorted by serial
+        std::vector<unsigned int> m_macOrder;       // positions in m_entries sorted by MAC
+        std::vector<UnitIndexEntry> m_pending;      // added since the last merge, sorted by serial
+        std::vector<unsigned int> m_pendingMacOrder;    // positions in m_pending sorted by MAC
+
+        // Arrays searched by lookups, either the vectors above
+        // or an attached file.
+        const UnitIndexEntry* m_searchEntries;
+        const unsigned int* m_searchMacOrder;
+        unsigned int m_searchCount;
+        bool m_isAttached;
+
+        void Merge();
+        void Detach();
+        void UseOwnedArrays();
+    };
+} // namespace EEasyXB
+
+#endif // UNIT_INDEX_H